@@ -44,6 +44,7 @@ private:
     string shopsCSV;
     string ambulancesCSV;
     string schoolBusesCSV;
+    string sectorDistancesCSV;  // Cache of the sector distance table (written on first run)
 
     // ========== STATE FLAGS ==========
     bool cityInitialized;
@@ -51,6 +52,7 @@ private:
 
     // ========== HELPER METHODS ==========
     void linkPopulationToGraph(); // The "Keystone" function
+    Vector<CityNode*> collectSectorNodes(const string& sectorName, int typeID) const; // typeID -1 = any type
 
 public:
     SmartCity();
@@ -96,12 +98,27 @@ public:
     int getCommutingCitizenCount() const;
 
     // ========== GRAPH/PATHFINDING APIs ==========
-    Vector<int> findShortestPath(int startID, int endID, double& outDistance);
-    Vector<int> findShortestPathByName(const string& startName, const string& endName, double& outDistance);
-    Vector<int> findShortestPathByDBID(const string& startDBID, const string& endDBID, double& outDistance);
+    Vector<int> findShortestPath(int startID, int endID, double& outDistance,
+        RouteSearchMode mode = RouteSearchMode::DEFAULT);
+    Vector<int> findShortestPathDynamic(int startID, int endID, double& outDistance,
+        RouteSearchMode mode = RouteSearchMode::DEFAULT);
+    // Prices each road at its predicted load on arrival (departureMinute -1 = now)
+    Vector<int> findShortestPathTimeDependent(int startID, int endID, double& outDistance,
+        int departureMinute = -1, RouteSearchMode mode = RouteSearchMode::DEFAULT);
+    Vector<int> findShortestPathByName(const string& startName, const string& endName, double& outDistance,
+        RouteSearchMode mode = RouteSearchMode::DEFAULT);
+    Vector<int> findShortestPathByDBID(const string& startDBID, const string& endDBID, double& outDistance,
+        RouteSearchMode mode = RouteSearchMode::DEFAULT);
+    void setRouteSearchMode(RouteSearchMode mode);
     int findNearestFacility(int fromNodeID, const string& facilityType);
     int findNearestFacilityByDBID(const string& fromDBID, const string& facilityType);
 
+    // ========== TRAFFIC ASSIGNMENT APIs ==========
+    // Morning commute: one trip per citizen from home to their workplace or school
+    Vector<TripDemand> getCommuteDemand() const;
+    // Equilibrium road loads for the commute demand; applyToRoads seeds live traffic with them
+    TrafficAssignmentResult predictRushHourTraffic(bool applyToRoads = false, int threadCount = 0);
+
     // ========== BUS TRANSPORT APIs ==========
     Bus* registerBus(const string& busNo, const string& company,
         const string& currentStop, const string& startStopID,
@@ -204,6 +221,11 @@ public:
     // ========== SECTOR ADJACENCY ==========
     static Vector<string> getAdjacentSectors(const string& sector);
     static bool areSectorsAdjacent(const string& sector1, const string& sector2);
+    // Road distance between the sector centres, from the precomputed table (INF if unknown)
+    double getSectorDistance(const string& fromSector, const string& toSector) const;
+    // Call after roads are added or removed at runtime: recomputes the sector distance table
+    // and the vehicle priority sectors ranked by it
+    void refreshSectorDistances();
 };
 
 // ============================================================================
@@ -233,6 +255,7 @@ inline SmartCity::SmartCity() {
     shopsCSV = "dataset/shops.csv";
     ambulancesCSV = "dataset/ambulances.csv";
     schoolBusesCSV = "dataset/schoolbuses.csv";
+    sectorDistancesCSV = "dataset/sector_distances.csv";
 }
 
 inline SmartCity::~SmartCity() {
@@ -295,7 +318,7 @@ inline bool SmartCity::initialize() {
 
     for (int i = 0; i < cityGraph->getNodeCount(); i++) {
         CityNode* node = cityGraph->getNode(i);
-        if (node && node->type == "STOP") {
+        if (node && node->typeID == FacilityType::ID_STOP) {
             transportManager->initializeStopQueue(node->id, node->name, node->sector);
         }
     }
@@ -321,6 +344,17 @@ inline bool SmartCity::initialize() {
     // Initialize AI Manager (The Brain)
     aiManager = new AIManager(cityGraph, populationManager, transportManager);
 
+    // The road network is complete: preprocess static-weight routing once up front
+    cityGraph->buildContractionHierarchy();
+
+    // Sector-to-sector distances: reuse the saved table if it was computed on this same
+    // road network, otherwise compute it on all cores and save it for the next start
+    if (!cityGraph->loadSectorDistanceTable(sectorDistancesCSV)) {
+        cityGraph->buildSectorDistanceTable();
+        cityGraph->saveSectorDistanceTable(sectorDistancesCSV);
+    }
+    transportManager->refreshPrioritySectors();
+
     cityInitialized = true;
     return true;
 }
@@ -425,11 +459,14 @@ inline CityStats SmartCity::getCityStats() const {
     for (int i = 0; i < cityGraph->getNodeCount(); i++) {
         CityNode* node = cityGraph->getNode(i);
         if (node) {
-            if (node->type == "STOP") stats.busStops++;
-            else if (node->type == "SCHOOL") stats.schoolNodes++;
-            else if (node->type == "HOSPITAL") stats.hospitalNodes++;
-            else if (node->type == "PHARMACY") stats.pharmacyNodes++;
-            else if (node->type == "CORNER") stats.sectorCorners++;
+            switch (node->typeID) {
+            case FacilityType::ID_STOP: stats.busStops++; break;
+            case FacilityType::ID_SCHOOL: stats.schoolNodes++; break;
+            case FacilityType::ID_HOSPITAL: stats.hospitalNodes++; break;
+            case FacilityType::ID_PHARMACY: stats.pharmacyNodes++; break;
+            case FacilityType::ID_CORNER: stats.sectorCorners++; break;
+            default: break;
+            }
         }
     }
 
@@ -478,29 +515,49 @@ inline TransportStats SmartCity::getTransportStats() const {
 
 // ========== GRAPH/PATHFINDING ==========
 
-inline Vector<int> SmartCity::findShortestPath(int startID, int endID, double& outDistance) {
+inline Vector<int> SmartCity::findShortestPath(int startID, int endID, double& outDistance,
+    RouteSearchMode mode) {
+    if (!cityInitialized) return Vector<int>();
+    return cityGraph->findShortestPath(startID, endID, outDistance, mode);
+}
+
+inline Vector<int> SmartCity::findShortestPathDynamic(int startID, int endID, double& outDistance,
+    RouteSearchMode mode) {
+    if (!cityInitialized) return Vector<int>();
+    return cityGraph->findShortestPathDynamic(startID, endID, outDistance, mode);
+}
+
+inline Vector<int> SmartCity::findShortestPathTimeDependent(int startID, int endID, double& outDistance,
+    int departureMinute, RouteSearchMode mode) {
     if (!cityInitialized) return Vector<int>();
-    return cityGraph->findShortestPath(startID, endID, outDistance);
+    return cityGraph->findShortestPathTimeDependent(startID, endID, outDistance, departureMinute, mode);
 }
 
 inline Vector<int> SmartCity::findShortestPathByName(const string& startName,
     const string& endName,
-    double& outDistance) {
+    double& outDistance,
+    RouteSearchMode mode) {
     if (!cityInitialized) return Vector<int>();
     int startID = cityGraph->getIDByName(startName);
     int endID = cityGraph->getIDByName(endName);
     if (startID == -1 || endID == -1) return Vector<int>();
-    return cityGraph->findShortestPath(startID, endID, outDistance);
+    return cityGraph->findShortestPath(startID, endID, outDistance, mode);
 }
 
 inline Vector<int> SmartCity::findShortestPathByDBID(const string& startDBID,
     const string& endDBID,
-    double& outDistance) {
+    double& outDistance,
+    RouteSearchMode mode) {
     if (!cityInitialized) return Vector<int>();
     int startID = cityGraph->getIDByDatabaseID(startDBID);
     int endID = cityGraph->getIDByDatabaseID(endDBID);
     if (startID == -1 || endID == -1) return Vector<int>();
-    return cityGraph->findShortestPath(startID, endID, outDistance);
+    return cityGraph->findShortestPath(startID, endID, outDistance, mode);
+}
+
+inline void SmartCity::setRouteSearchMode(RouteSearchMode mode) {
+    if (!cityInitialized) return;
+    cityGraph->setDefaultSearchMode(mode);
 }
 
 inline int SmartCity::findNearestFacility(int fromNodeID, const string& facilityType) {
@@ -515,6 +572,32 @@ inline int SmartCity::findNearestFacilityByDBID(const string& fromDBID, const st
     return cityGraph->findNearestFacility(fromID, facilityType);
 }
 
+// ========== TRAFFIC ASSIGNMENT ==========
+
+inline Vector<TripDemand> SmartCity::getCommuteDemand() const {
+    Vector<TripDemand> demand;
+    if (!cityInitialized || !populationManager) return demand;
+
+    const Vector<Citizen*>& citizens = populationManager->masterList;
+    for (int i = 0; i < citizens.getSize(); i++) {
+        Citizen* c = citizens[i];
+        if (!c || c->homeNodeID < 0) continue;
+
+        int destination = (c->workplaceNodeID != -1) ? c->workplaceNodeID : c->schoolNodeID;
+        if (destination != -1 && destination != c->homeNodeID) {
+            demand.push_back(TripDemand(c->homeNodeID, destination));
+        }
+    }
+    return demand;
+}
+
+inline TrafficAssignmentResult SmartCity::predictRushHourTraffic(bool applyToRoads, int threadCount) {
+    if (!cityInitialized) return TrafficAssignmentResult();
+    TrafficAssignmentResult result = cityGraph->assignTraffic(getCommuteDemand(), threadCount);
+    if (applyToRoads) cityGraph->applyTrafficAssignment(result);
+    return result;
+}
+
 // ========== BUS TRANSPORT ==========
 
 inline Bus* SmartCity::registerBus(const string& busNo, const string& company,
@@ -529,7 +612,7 @@ inline Bus* SmartCity::registerBus(const string& busNo, const string& company,
 
     if (startNodeID != -1 && endNodeID != -1) {
         double distance = 0.0;
-        Vector<int> route = cityGraph->findShortestPath(startNodeID, endNodeID, distance);
+        Vector<int> route = cityGraph->calculateBusRoute(startNodeID, endNodeID, distance);
         if (route.getSize() > 0) {
             transportManager->setBusRoute(busNo, route, distance, startStopID, endStopID);
         }
@@ -637,7 +720,7 @@ inline void SmartCity::generatePickupPointsForSector(const string& sector) {
     for (int i = 0; i < cityGraph->getNodeCount(); i++) {
         CityNode* node = cityGraph->getNode(i);
         if (node && node->sector == sector) {
-            if (node->type == "CORNER" || node->type == "STOP") {
+            if (node->typeID == FacilityType::ID_CORNER || node->typeID == FacilityType::ID_STOP) {
                 transportManager->createPickupPoint(node->id, sector, node->name, true);
             }
         }
@@ -705,14 +788,8 @@ inline bool SmartCity::routeAmbulanceToHospital(Ambulance* amb, const string& ho
     int hospitalNodeID = cityGraph->getIDByDatabaseID(hospitalID);
     if (hospitalNodeID == -1) return false;
 
-    double distance = 0.0;
-    Vector<int> route = cityGraph->findShortestPath(amb->getCurrentNodeID(),
-        hospitalNodeID, distance);
-    if (route.getSize() > 0) {
-        amb->setRouteSimple(route, distance);
-        return true;
-    }
-    return false;
+    // Rerouted around congestion on the way
+    return transportManager->routeVehicleTo(amb, hospitalNodeID);
 }
 
 // ========== POPULATION ==========
@@ -781,23 +858,32 @@ inline Vector<Pharmacy*> SmartCity::findPharmaciesByFormula(const string& formul
 inline Hospital* SmartCity::findNearestAvailableHospital(int fromNodeID) {
     if (!cityInitialized) return nullptr;
 
-    Hospital* nearest = nullptr;
-    double minDistance = 1e9;
-
+    // Candidates with free beds, then one search for the distances to all of them
+    Vector<Hospital*> candidates;
+    Vector<int> candidateNodes;
     for (int i = 0; i < medicalManager->hospitals.getSize(); i++) {
         Hospital* h = medicalManager->hospitals[i];
         if (h->getAvailableBeds() > 0) {
             int hospitalNodeID = cityGraph->getIDByDatabaseID(h->id);
             if (hospitalNodeID != -1) {
-                double dist = 0.0;
-                Vector<int> path = cityGraph->findShortestPath(fromNodeID, hospitalNodeID, dist);
-                if (path.getSize() > 0 && dist < minDistance) {
-                    minDistance = dist;
-                    nearest = h;
-                }
+                candidates.push_back(h);
+                candidateNodes.push_back(hospitalNodeID);
             }
         }
     }
+
+    Vector<int> from;
+    from.push_back(fromNodeID);
+    Vector<double> distances = cityGraph->distanceMatrix(from, candidateNodes);
+
+    Hospital* nearest = nullptr;
+    double minDistance = INF;
+    for (int i = 0; i < candidates.getSize(); i++) {
+        if (distances[i] < minDistance) {
+            minDistance = distances[i];
+            nearest = candidates[i];
+        }
+    }
     return nearest;
 }
 
@@ -906,54 +992,40 @@ inline void SmartCity::updateAmbulances() {
 
 // ========== SECTOR QUERIES ==========
 
-inline Vector<CityNode*> SmartCity::getNodesInSector(const string& sectorName) const {
+// Resolves the sector name once and scans the graph's per-node sector / type IDs
+inline Vector<CityNode*> SmartCity::collectSectorNodes(const string& sectorName, int typeID) const {
     Vector<CityNode*> result;
     if (!cityInitialized) return result;
+
+    int sectorIdx = GeometryUtils::getSectorIndex(sectorName);
+    if (sectorIdx == -1 && sectorName != "Unknown") return result;
+
     for (int i = 0; i < cityGraph->getNodeCount(); i++) {
-        CityNode* node = cityGraph->getNode(i);
-        if (node && node->sector == sectorName) result.push_back(node);
+        if (cityGraph->getNodeSectorIndex(i) != sectorIdx) continue;
+        if (typeID != -1 && cityGraph->getNodeTypeID(i) != typeID) continue;
+        result.push_back(cityGraph->getNode(i));
     }
     return result;
 }
 
+inline Vector<CityNode*> SmartCity::getNodesInSector(const string& sectorName) const {
+    return collectSectorNodes(sectorName, -1);
+}
+
 inline Vector<CityNode*> SmartCity::getSchoolsInSector(const string& sectorName) const {
-    Vector<CityNode*> result;
-    if (!cityInitialized) return result;
-    for (int i = 0; i < cityGraph->getNodeCount(); i++) {
-        CityNode* node = cityGraph->getNode(i);
-        if (node && node->sector == sectorName && node->type == "SCHOOL") result.push_back(node);
-    }
-    return result;
+    return collectSectorNodes(sectorName, FacilityType::ID_SCHOOL);
 }
 
 inline Vector<CityNode*> SmartCity::getHospitalsInSector(const string& sectorName) const {
-    Vector<CityNode*> result;
-    if (!cityInitialized) return result;
-    for (int i = 0; i < cityGraph->getNodeCount(); i++) {
-        CityNode* node = cityGraph->getNode(i);
-        if (node && node->sector == sectorName && node->type == "HOSPITAL") result.push_back(node);
-    }
-    return result;
+    return collectSectorNodes(sectorName, FacilityType::ID_HOSPITAL);
 }
 
 inline Vector<CityNode*> SmartCity::getPharmaciesInSector(const string& sectorName) const {
-    Vector<CityNode*> result;
-    if (!cityInitialized) return result;
-    for (int i = 0; i < cityGraph->getNodeCount(); i++) {
-        CityNode* node = cityGraph->getNode(i);
-        if (node && node->sector == sectorName && node->type == "PHARMACY") result.push_back(node);
-    }
-    return result;
+    return collectSectorNodes(sectorName, FacilityType::ID_PHARMACY);
 }
 
 inline Vector<CityNode*> SmartCity::getStopsInSector(const string& sectorName) const {
-    Vector<CityNode*> result;
-    if (!cityInitialized) return result;
-    for (int i = 0; i < cityGraph->getNodeCount(); i++) {
-        CityNode* node = cityGraph->getNode(i);
-        if (node && node->sector == sectorName && node->type == "STOP") result.push_back(node);
-    }
-    return result;
+    return collectSectorNodes(sectorName, FacilityType::ID_STOP);
 }
 
 // ========== SECTOR ADJACENCY ==========
@@ -964,4 +1036,16 @@ inline Vector<string> SmartCity::getAdjacentSectors(const string& sector) {
 
 inline bool SmartCity::areSectorsAdjacent(const string& sector1, const string& sector2) {
     return TransportManager::areSectorsAdjacent(sector1, sector2);
+}
+
+inline double SmartCity::getSectorDistance(const string& fromSector, const string& toSector) const {
+    if (!cityInitialized) return INF;
+    return cityGraph->getSectorDistance(fromSector, toSector);
+}
+
+// The saved copy is left alone: it matches the dataset's network, which the next start loads
+inline void SmartCity::refreshSectorDistances() {
+    if (!cityInitialized) return;
+    cityGraph->buildSectorDistanceTable();
+    transportManager->refreshPrioritySectors();
 }
\ No newline at end of file
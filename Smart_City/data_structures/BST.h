@@ -1,6 +1,7 @@
 #pragma once
 #include <stdexcept>
 #include "Vector.h"
+#include "NodePool.h"
 
 namespace re {
 
@@ -18,10 +19,11 @@ namespace re {
 
         Node* root;
         int nodeCount;
+        NodePool<Node> pool;    // Every node of this tree; removed nodes are reused
 
         Node* copyTree(Node* other) {
             if (!other) return nullptr;
-            Node* node = new Node(other->data);
+            Node* node = pool.create(other->data);
             node->left  = copyTree(other->left);
             node->right = copyTree(other->right);
             return node;
@@ -31,13 +33,13 @@ namespace re {
             if (!node) return;
             destroySubtree(node->left);
             destroySubtree(node->right);
-            delete node;
+            pool.destroy(node);
         }
 
         Node* insertNode(Node* node, const T& value) {
             if (!node) {
                 nodeCount++;
-                return new Node(value);
+                return pool.create(value);
             }
             if (value < node->data) {
                 node->left = insertNode(node->left, value);
@@ -64,15 +66,15 @@ namespace re {
             } else {
                 removed = true;
                 if (!node->left && !node->right) {
-                    delete node;
+                    pool.destroy(node);
                     return nullptr;
                 } else if (!node->left) {
                     Node* temp = node->right;
-                    delete node;
+                    pool.destroy(node);
                     return temp;
                 } else if (!node->right) {
                     Node* temp = node->left;
-                    delete node;
+                    pool.destroy(node);
                     return temp;
                 } else {
                     Node* succ = findMin(node->right);
@@ -154,8 +156,9 @@ namespace re {
             return *this;
         }
 
+        // Frees the node storage a slab at once (without visiting the nodes if T needs no destructor)
         ~BST() {
-            clear();
+            if constexpr (!NODE_POOL_SKIP_DESTROY<Node>) clear();
         }
 
         bool empty() const { return nodeCount == 0; }
@@ -1,129 +1,165 @@
 #pragma once
-#include "LinkedLists.h"
+#include "RingBuffer.h"
+#include "Vector.h"
 #include <stdexcept>
 
+// FIFO queue on a ring buffer, optionally bounded: with a capacity > 0, enqueue() refuses
+// new elements once the queue holds that many. The buffer grows on demand up to the bound
+// and is then reused, so a busy stop's queue stops allocating after its first rush.
 template <typename T>
 class CircularQueue {
 private:
-    CircularList<T> list;
-    int maxCapacity;  
+    RingBuffer<T> buffer;
+    int maxCapacity;    // 0 = unbounded
 
 public:
-  
-    
-    CircularQueue() : list(), maxCapacity(0) {}
-    
-    explicit CircularQueue(int capacity) : list(), maxCapacity(capacity) {}
-    
-    CircularQueue(const CircularQueue& other) 
-        : list(other.list), maxCapacity(other.maxCapacity) {}
-    
+    CircularQueue() : buffer(), maxCapacity(0) {}
+
+    explicit CircularQueue(int capacity) : buffer(), maxCapacity(capacity) {}
+
+    CircularQueue(const CircularQueue& other)
+        : buffer(other.buffer), maxCapacity(other.maxCapacity) {}
+
+    CircularQueue(CircularQueue&& other) noexcept
+        : buffer(std::move(other.buffer)), maxCapacity(other.maxCapacity) {}
+
     CircularQueue& operator=(const CircularQueue& other) {
         if (this != &other) {
-            list = other.list;
+            buffer = other.buffer;
+            maxCapacity = other.maxCapacity;
+        }
+        return *this;
+    }
+
+    CircularQueue& operator=(CircularQueue&& other) noexcept {
+        if (this != &other) {
+            buffer = std::move(other.buffer);
             maxCapacity = other.maxCapacity;
         }
         return *this;
     }
-    
+
     ~CircularQueue() = default;
-    
-    
-    bool empty() const { return list.empty(); }
-    int size() const { return list.size(); }
-    int getSize() const { return list.getSize(); }
-    
+
+
+    bool empty() const { return buffer.empty(); }
+    int size() const { return buffer.size(); }
+    int getSize() const { return buffer.size(); }
+
     bool isFull() const {
-        return maxCapacity > 0 && list.size() >= maxCapacity;
+        return maxCapacity > 0 && buffer.size() >= maxCapacity;
     }
-    
+
     int capacity() const { return maxCapacity; }
-    
+
+    // Lowering the bound below the current size keeps the queued elements but refuses new ones
     void setCapacity(int cap) { maxCapacity = cap; }
-    
-    
+
+
     T& front() {
         if (empty()) throw std::runtime_error("CircularQueue is empty");
-        return list.front();
+        return buffer[0];
     }
-    
+
     const T& front() const {
         if (empty()) throw std::runtime_error("CircularQueue is empty");
-        return list.front();
+        return buffer[0];
     }
-    
+
     T& back() {
         if (empty()) throw std::runtime_error("CircularQueue is empty");
-        return list.back();
+        return buffer[buffer.size() - 1];
     }
-    
+
     const T& back() const {
         if (empty()) throw std::runtime_error("CircularQueue is empty");
-        return list.back();
+        return buffer[buffer.size() - 1];
     }
-    
+
+    // O(1): index 0 is the front
     T& at(int index) {
-        if (index < 0 || index >= list.size())
+        if (index < 0 || index >= buffer.size())
             throw std::out_of_range("Index out of range");
-        return list.at(index);
+        return buffer[index];
     }
-    
+
     const T& at(int index) const {
-        if (index < 0 || index >= list.size())
+        if (index < 0 || index >= buffer.size())
             throw std::out_of_range("Index out of range");
-        return list.at(index);
+        return buffer[index];
     }
-    
-    
+
+
     bool enqueue(const T& value) {
         if (isFull()) return false;
-        list.push_back(value);
+        buffer.emplace_back(value);
+        return true;
+    }
+
+    bool enqueue(T&& value) {
+        if (isFull()) return false;
+        buffer.emplace_back(std::move(value));
         return true;
     }
-    
+
     bool push(const T& value) { return enqueue(value); }
-    
+    bool push(T&& value) { return enqueue(std::move(value)); }
+
+    // Removes the front element and returns it by move
     T dequeue() {
         if (empty()) throw std::runtime_error("CircularQueue is empty");
-        T value = list.front();
-        list.pop_front();
-        return value;
+        return buffer.take_front();
     }
-    
+
     T pop() { return dequeue(); }
-    
+
     void pop_front() {
         if (empty()) throw std::runtime_error("CircularQueue is empty");
-        list.pop_front();
+        buffer.pop_front();
     }
-    
-    void clear() { list.clear(); }
-    
-    
+
+    // Moves up to n front elements to the end of out, in queue order; returns how many
+    int drain(int n, Vector<T>& out) {
+        int moved = 0;
+        while (moved < n && !empty()) {
+            out.emplace_back(std::move(buffer[0]));
+            buffer.pop_front();
+            moved++;
+        }
+        return moved;
+    }
+
+    // Keeps the buffer for refilling
+    void clear() { buffer.clear(); }
+
+
+    // Moves the front element to the back
     void rotate() {
-        list.rotate();
+        buffer.rotate(1);
     }
-    
+
     void rotate(int n) {
-        list.rotate(n);
+        buffer.rotate(n);
     }
-    
-    
+
+
     int find(const T& value) const {
-        return list.find(value);
+        return buffer.find(value);
     }
-    
+
     bool contains(const T& value) const {
-        return list.contains(value);
+        return buffer.find(value) != -1;
     }
-    
+
     void remove(const T& value) {
-        list.remove(value);
+        int index = buffer.find(value);
+        if (index != -1)
+            buffer.erase(index);
     }
-    
-    
+
+
     void swap(CircularQueue& other) {
-        list.swap(other.list);
+        buffer.swap(other.buffer);
         int temp = maxCapacity;
         maxCapacity = other.maxCapacity;
         other.maxCapacity = temp;
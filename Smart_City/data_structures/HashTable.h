@@ -1,129 +1,273 @@
 #pragma once
 #include <string>
+#include <string_view>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <new>
 #include <stdexcept>
 #include <iostream>
 
-template <typename K, typename V>
-struct HashNode {
-    K key;
-    V value;
-    HashNode* next;
+// ==================== HASH TRAITS ====================
+// Hasher::hash(key) must return well-mixed bits in every position: the table takes its
+// slot from the high bits and a 7-bit fingerprint from the low ones.
+// A hasher may accept more key types than K (heterogeneous lookup): HashTraits<std::string>
+// hashes any string_view-convertible key, so get("F-7") builds no temporary string.
 
-    HashNode(const K& k, const V& v) : key(k), value(v), next(nullptr) {}
+inline unsigned long long mixHash(unsigned long long x) {
+    // splitmix64 finalizer
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+template <typename K, typename = void>
+struct HashTraits {
+    static unsigned long long hash(const K& key) { return mixHash((unsigned long long)std::hash<K>{}(key)); }
+};
+
+template <typename K>
+struct HashTraits<K, typename std::enable_if<std::is_integral<K>::value || std::is_enum<K>::value>::type> {
+    static unsigned long long hash(K key) { return mixHash((unsigned long long)key); }
+};
+
+template <>
+struct HashTraits<std::string> {
+    // FNV-1a, one multiply per character
+    static unsigned long long hash(std::string_view key) {
+        unsigned long long h = 0xcbf29ce484222325ULL;
+        for (char c : key) {
+            h ^= (unsigned char)c;
+            h *= 0x100000001b3ULL;
+        }
+        return mixHash(h);
+    }
 };
 
-template <typename K, typename V>
+// ==================== HASH TABLE ====================
+// Open addressing with one metadata byte per slot (SwissTable layout): a full slot stores the
+// low 7 bits of its key's hash, so a probe compares keys only on a fingerprint match and
+// stops at the first empty slot. Removal leaves a tombstone instead of moving entries.
+// The slot count is a power of two and doubles once entries and tombstones pass 7/8 of it.
+//
+// A pointer returned by get() stays valid until the next insert that grows the table,
+// clear() or the table's destruction; remove() only invalidates the removed entry's.
+
+template <typename K, typename V, typename Hasher = HashTraits<K>>
 class HashTable {
 private:
-    HashNode<K, V>** table; 
-    int capacity;          
-    int size;               
+    struct Slot {
+        K key;
+        V value;
+        Slot(const K& k, const V& v) : key(k), value(v) {}
+        Slot(K&& k, V&& v) : key(std::move(k)), value(std::move(v)) {}
+    };
 
+    static constexpr unsigned char EMPTY = 0x80;
+    static constexpr unsigned char DELETED = 0xFE;
 
-    unsigned long hashFunction(const std::string& key) const {
-        unsigned long hash = 0;
-        unsigned long p = 31;     
-        unsigned long m = capacity;
-        unsigned long p_pow = 1;
+    unsigned char* control;     // Per slot: EMPTY, DELETED or the 7-bit fingerprint of a full slot
+    Slot* slots;                // Raw storage; only full slots hold a constructed entry
+    int capacity;               // Power of two
+    int size;
+    int tombstones;
 
-        for (char c : key) {
-            hash = (hash + (c * p_pow)) % m;
-            p_pow = (p_pow * p) % m;
+    static unsigned char fingerprint(unsigned long long h) { return (unsigned char)(h & 0x7F); }
+    int home(unsigned long long h) const { return (int)((h >> 7) & (unsigned long long)(capacity - 1)); }
+
+    static int slotsFor(int expected) {
+        int cap = 8;
+        while ((long long)cap * 7 / 8 < expected) cap *= 2;
+        return cap;
+    }
+
+    void allocate(int cap) {
+        capacity = cap;
+        control = new unsigned char[capacity];
+        for (int i = 0; i < capacity; i++) control[i] = EMPTY;
+        slots = static_cast<Slot*>(::operator new(sizeof(Slot) * capacity));
+        size = 0;
+        tombstones = 0;
+    }
+
+    void release() {
+        if (!control) return;
+        for (int i = 0; i < capacity; i++) {
+            if (control[i] < EMPTY) slots[i].~Slot();
         }
-        return hash;
+        delete[] control;
+        ::operator delete(slots);
+        control = nullptr;
+        slots = nullptr;
     }
 
-    unsigned long hashFunction(int key) const {
-        return key % capacity;
+    // Slot holding key, or -1
+    template <typename Q>
+    int findSlot(const Q& key) const {
+        unsigned long long h = Hasher::hash(key);
+        unsigned char tag = fingerprint(h);
+        int mask = capacity - 1;
+        for (int i = home(h); ; i = (i + 1) & mask) {
+            unsigned char c = control[i];
+            if (c == tag && slots[i].key == key) return i;
+            if (c == EMPTY) return -1;
+        }
     }
 
-public:
-    HashTable(int cap = 101) : capacity(cap), size(0) {
-        table = new HashNode<K, V>* [capacity];
+    // First empty or deleted slot on key's probe sequence (the key must not be present)
+    int freeSlot(unsigned long long h) const {
+        int mask = capacity - 1;
+        int i = home(h);
+        while (control[i] < EMPTY) i = (i + 1) & mask;
+        return i;
+    }
+
+    // Moves every entry into a fresh array; also the only way tombstones are cleared
+    void rehash(int newCapacity) {
+        unsigned char* oldControl = control;
+        Slot* oldSlots = slots;
+        int oldCapacity = capacity;
+
+        allocate(newCapacity);
+        for (int i = 0; i < oldCapacity; i++) {
+            if (oldControl[i] >= EMPTY) continue;
+            unsigned long long h = Hasher::hash(oldSlots[i].key);
+            int s = freeSlot(h);
+            new (&slots[s]) Slot(std::move(oldSlots[i].key), std::move(oldSlots[i].value));
+            control[s] = fingerprint(h);
+            size++;
+            oldSlots[i].~Slot();
+        }
+        delete[] oldControl;
+        ::operator delete(oldSlots);
+    }
+
+    // Makes room for one more entry; grows unless tombstones are most of the load
+    void prepareInsert() {
+        if ((long long)(size + tombstones + 1) * 8 <= (long long)capacity * 7) return;
+        rehash((size + 1 > capacity / 2) ? capacity * 2 : capacity);
+    }
+
+    // Slot-for-slot copy (tombstones included, so every entry stays on its probe sequence)
+    void copyFrom(const HashTable& other) {
+        allocate(other.capacity);
         for (int i = 0; i < capacity; i++) {
-            table[i] = nullptr;
+            if (other.control[i] < EMPTY) new (&slots[i]) Slot(other.slots[i].key, other.slots[i].value);
+            control[i] = other.control[i];
         }
+        size = other.size;
+        tombstones = other.tombstones;
     }
 
-    ~HashTable() {
-        clear();
-        delete[] table;
+public:
+    // expectedSize entries fit without growing
+    HashTable(int expectedSize = 16) : control(nullptr), slots(nullptr) {
+        allocate(slotsFor(expectedSize));
     }
 
+    HashTable(const HashTable& other) : control(nullptr), slots(nullptr) {
+        copyFrom(other);
+    }
 
-    void insert(const K& key, const V& value) {
-        unsigned long index = hashFunction(key);
+    HashTable(HashTable&& other) noexcept
+        : control(other.control), slots(other.slots), capacity(other.capacity),
+        size(other.size), tombstones(other.tombstones) {
+        other.control = nullptr;
+        other.slots = nullptr;
+        other.allocate(8);
+    }
 
-        HashNode<K, V>* current = table[index];
+    HashTable& operator=(const HashTable& other) {
+        if (this == &other) return *this;
+        release();
+        copyFrom(other);
+        return *this;
+    }
+
+    HashTable& operator=(HashTable&& other) noexcept {
+        if (this == &other) return *this;
+        release();
+        control = other.control;
+        slots = other.slots;
+        capacity = other.capacity;
+        size = other.size;
+        tombstones = other.tombstones;
+        other.control = nullptr;
+        other.slots = nullptr;
+        other.allocate(8);
+        return *this;
+    }
 
-        while (current != nullptr) {
-            if (current->key == key) {
-                current->value = value;
-                return;
-            }
-            current = current->next;
+    ~HashTable() {
+        release();
+    }
+
+
+    void insert(const K& key, const V& value) {
+        int existing = findSlot(key);
+        if (existing != -1) {
+            slots[existing].value = value;
+            return;
         }
 
-        HashNode<K, V>* newNode = new HashNode<K, V>(key, value);
-        newNode->next = table[index];
-        table[index] = newNode;
+        prepareInsert();
+        unsigned long long h = Hasher::hash(key);
+        int s = freeSlot(h);
+        if (control[s] == DELETED) tombstones--;
+        new (&slots[s]) Slot(key, value);
+        control[s] = fingerprint(h);
         size++;
     }
 
-    V* get(const K& key) const {
-        unsigned long index = hashFunction(key);
-        HashNode<K, V>* current = table[index];
+    template <typename Q = K>
+    V* get(const Q& key) const {
+        int s = findSlot(key);
+        return (s == -1) ? nullptr : &slots[s].value;
+    }
 
-        while (current != nullptr) {
-            if (current->key == key) {
-                return &(current->value);
-            }
-            current = current->next;
+    template <typename Q = K>
+    bool contains(const Q& key) const {
+        return findSlot(key) != -1;
+    }
+
+    template <typename Q = K>
+    bool remove(const Q& key) {
+        int s = findSlot(key);
+        if (s == -1) return false;
+
+        slots[s].~Slot();
+        // A slot followed by an empty one ends every probe sequence through it already
+        if (control[(s + 1) & (capacity - 1)] == EMPTY) {
+            control[s] = EMPTY;
         }
-        return nullptr;
-    }
-
-    bool contains(const K& key) const {
-        return get(key) != nullptr;
-    }
-
-    bool remove(const K& key) {
-        unsigned long index = hashFunction(key);
-        HashNode<K, V>* current = table[index];
-        HashNode<K, V>* prev = nullptr;
-
-        while (current != nullptr) {
-            if (current->key == key) {
-                if (prev == nullptr) {
-                    table[index] = current->next;
-                }
-                else {
-                    prev->next = current->next;
-                }
-                delete current;
-                size--;
-                return true;
-            }
-            prev = current;
-            current = current->next;
+        else {
+            control[s] = DELETED;
+            tombstones++;
         }
-        return false;
+        size--;
+        return true;
     }
 
     void clear() {
         for (int i = 0; i < capacity; i++) {
-            HashNode<K, V>* current = table[i];
-            while (current != nullptr) {
-                HashNode<K, V>* toDelete = current;
-                current = current->next;
-                delete toDelete;
-            }
-            table[i] = nullptr;
+            if (control[i] < EMPTY) slots[i].~Slot();
+            control[i] = EMPTY;
         }
         size = 0;
+        tombstones = 0;
+    }
+
+    // Grows (never shrinks) so that expectedSize entries fit without another rehash
+    void reserve(int expectedSize) {
+        int cap = slotsFor(expectedSize);
+        if (cap > capacity) rehash(cap);
     }
 
     int getSize() const { return size; }
+    int getCapacity() const { return capacity; }
 
     bool isEmpty() const { return size == 0; }
 };
@@ -2,6 +2,7 @@
 
 #pragma once
 #include <stdexcept>
+#include "NodePool.h"
 
 template <typename T>
 class LinkedList {
@@ -17,6 +18,7 @@ private:
     Node* head;
     Node* tail;
     int m_size;
+    NodePool<Node> pool;    // Every node of this list; nodes freed by pop/erase are reused
 
 public:
     
@@ -30,6 +32,12 @@ public:
         }
     }
     
+    LinkedList(LinkedList&& other) noexcept : head(other.head), tail(other.tail), m_size(other.m_size) {
+        other.head = other.tail = nullptr;
+        other.m_size = 0;
+        pool.swap(other.pool);
+    }
+    
     LinkedList& operator=(const LinkedList& other) {
         if (this == &other) return *this;
         
@@ -42,8 +50,9 @@ public:
         return *this;
     }
     
+    // Frees the node storage a slab at once (without visiting the nodes if T needs no destructor)
     ~LinkedList() {
-        clear();
+        if constexpr (!NODE_POOL_SKIP_DESTROY<Node>) clear();
     }
     
     
@@ -91,7 +100,7 @@ public:
     
     // Front O(1)
     void push_front(const T& value) {
-        Node* newNode = new Node(value);
+        Node* newNode = pool.create(value);
         newNode->next = head;
         head = newNode;
         
@@ -103,7 +112,7 @@ public:
     
     // Back O(1) 
     void push_back(const T& value) {
-        Node* newNode = new Node(value);
+        Node* newNode = pool.create(value);
         
         if (m_size == 0) {
             head = tail = newNode;
@@ -120,7 +129,7 @@ public:
         
         Node* temp = head;
         head = head->next;
-        delete temp;
+        pool.destroy(temp);
         --m_size;
         
         if (m_size == 0) {
@@ -133,7 +142,7 @@ public:
         if (empty()) return;
         
         if (m_size == 1) {
-            delete head;
+            pool.destroy(head);
             head = tail = nullptr;
             m_size = 0;
             return;
@@ -144,7 +153,7 @@ public:
             curr = curr->next;
         }
         
-        delete tail;
+        pool.destroy(tail);
         tail = curr;
         tail->next = nullptr;
         --m_size;
@@ -165,7 +174,7 @@ public:
         }
         
         Node* prev = nodeAt(index - 1);
-        Node* newNode = new Node(value);
+        Node* newNode = pool.create(value);
         newNode->next = prev->next;
         prev->next = newNode;
         ++m_size;
@@ -188,15 +197,16 @@ public:
             tail = prev;
         }
         
-        delete toDelete;
+        pool.destroy(toDelete);
         --m_size;
     }
     
+    // The nodes go back to the pool for the next push
     void clear() {
         while (head) {
             Node* temp = head;
             head = head->next;
-            delete temp;
+            pool.destroy(temp);
         }
         head = tail = nullptr;
         m_size = 0;
@@ -214,6 +224,8 @@ public:
         other.head = tempHead;
         other.tail = tempTail;
         other.m_size = tempSize;
+
+        pool.swap(other.pool);
     }
     
     
@@ -250,7 +262,7 @@ public:
                     tail = curr;
                 }
                 
-                delete toDelete;
+                pool.destroy(toDelete);
                 --m_size;
                 return;
             }
@@ -321,6 +333,7 @@ private:
     Node* head;
     Node* tail;  
     int m_size;
+    NodePool<Node> pool;    // Every node of this list; nodes freed by pop/erase are reused
 
 public:
     CircularList() : head(nullptr), tail(nullptr), m_size(0) {}
@@ -335,6 +348,12 @@ public:
         }
     }
     
+    CircularList(CircularList&& other) noexcept : head(other.head), tail(other.tail), m_size(other.m_size) {
+        other.head = other.tail = nullptr;
+        other.m_size = 0;
+        pool.swap(other.pool);
+    }
+    
     CircularList& operator=(const CircularList& other) {
         if (this == &other) return *this;
         
@@ -349,8 +368,9 @@ public:
         return *this;
     }
     
+    // Frees the node storage a slab at once (without visiting the nodes if T needs no destructor)
     ~CircularList() {
-        clear();
+        if constexpr (!NODE_POOL_SKIP_DESTROY<Node>) clear();
     }
     
     
@@ -397,7 +417,7 @@ public:
     
     
     void push_front(const T& value) {
-        Node* newNode = new Node(value);
+        Node* newNode = pool.create(value);
         
         if (m_size == 0) {
             head = tail = newNode;
@@ -411,7 +431,7 @@ public:
     }
     
     void push_back(const T& value) {
-        Node* newNode = new Node(value);
+        Node* newNode = pool.create(value);
         
         if (m_size == 0) {
             head = tail = newNode;
@@ -428,7 +448,7 @@ public:
         if (empty()) return;
         
         if (m_size == 1) {
-            delete head;
+            pool.destroy(head);
             head = tail = nullptr;
             m_size = 0;
             return;
@@ -437,7 +457,7 @@ public:
         Node* temp = head;
         head = head->next;
         tail->next = head;
-        delete temp;
+        pool.destroy(temp);
         --m_size;
     }
     
@@ -445,7 +465,7 @@ public:
         if (empty()) return;
         
         if (m_size == 1) {
-            delete head;
+            pool.destroy(head);
             head = tail = nullptr;
             m_size = 0;
             return;
@@ -456,7 +476,7 @@ public:
             curr = curr->next;
         }
         
-        delete tail;
+        pool.destroy(tail);
         tail = curr;
         tail->next = head;
         --m_size;
@@ -477,7 +497,7 @@ public:
         }
         
         Node* prev = nodeAt(index - 1);
-        Node* newNode = new Node(value);
+        Node* newNode = pool.create(value);
         newNode->next = prev->next;
         prev->next = newNode;
         ++m_size;
@@ -500,10 +520,11 @@ public:
         Node* prev = nodeAt(index - 1);
         Node* toDelete = prev->next;
         prev->next = toDelete->next;
-        delete toDelete;
+        pool.destroy(toDelete);
         --m_size;
     }
     
+    // The nodes go back to the pool for the next push
     void clear() {
         if (m_size == 0) {
             head = tail = nullptr;
@@ -513,7 +534,7 @@ public:
         Node* curr = head;
         for (int i = 0; i < m_size; ++i) {
             Node* next = curr->next;
-            delete curr;
+            pool.destroy(curr);
             curr = next;
         }
         
@@ -533,6 +554,8 @@ public:
         other.head = tempHead;
         other.tail = tempTail;
         other.m_size = tempSize;
+
+        pool.swap(other.pool);
     }
     
     
@@ -569,7 +592,7 @@ public:
                 }
                 
                 curr->next = toDelete->next;
-                delete toDelete;
+                pool.destroy(toDelete);
                 --m_size;
                 return;
             }
@@ -1,5 +1,6 @@
 #pragma once
 #include "Vector.h"
+#include "NodePool.h"
 #include <stdexcept>
 
 template <typename T>
@@ -18,6 +19,7 @@ public:
 private:
     Node* root;
     int nodeCount;
+    NodePool<Node> pool;    // Every node of this tree; removed nodes are reused
 
 public:
     NaryTree() : root(nullptr), nodeCount(0) {}
@@ -56,7 +58,7 @@ public:
     Node* setRoot(const T& value) {
         if (root != nullptr)
             throw std::logic_error("Root already exists");
-        root = new Node(value, nullptr);
+        root = pool.create(value, nullptr);
         nodeCount = 1;
         return root;
     }
@@ -65,7 +67,7 @@ public:
         if (parent == nullptr)
             throw std::invalid_argument("Parent cannot be null");
 
-        Node* child = new Node(value, parent);
+        Node* child = pool.create(value, parent);
         parent->children.push_back(child);
         ++nodeCount;
         return child;
@@ -142,7 +144,7 @@ private:
         if (!otherNode)
             return nullptr;
 
-        Node* newNode = new Node(otherNode->data, parent);
+        Node* newNode = pool.create(otherNode->data, parent);
 
         int n = otherNode->children.getSize();
         for (int i = 0; i < n; ++i) {
@@ -164,7 +166,7 @@ private:
             removed += deleteSubtree(node->children[i]);
         }
 
-        delete node;
+        pool.destroy(node);
         return removed;
     }
 };
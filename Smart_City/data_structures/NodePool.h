@@ -0,0 +1,138 @@
+#pragma once
+#include <new>
+#include <utility>
+#include <type_traits>
+
+// Fixed-size object storage for node-based containers. Objects are carved out of slabs that
+// double in size (NODE_POOL_FIRST_SLAB objects, then twice as many, up to NODE_POOL_MAX_SLAB),
+// and destroyed objects go on a free list for the next create(), so a container that keeps
+// churning stops calling operator new. Objects never move while they live.
+//
+// release() hands every slab back at once without visiting the objects: call it after the
+// objects have been destroyed, or instead of destroying them when they are trivially
+// destructible (see NODE_POOL_SKIP_DESTROY).
+constexpr int NODE_POOL_FIRST_SLAB = 4;
+constexpr int NODE_POOL_MAX_SLAB = 256;
+
+template <typename T>
+constexpr bool NODE_POOL_SKIP_DESTROY = std::is_trivially_destructible<T>::value;
+
+template <typename T>
+class NodePool {
+private:
+    union Slot {
+        Slot* nextFree;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    struct alignas(Slot) Slab {
+        Slab* next;
+        Slot* slots() { return reinterpret_cast<Slot*>(this + 1); }
+    };
+
+    Slab* slabs;
+    Slot* freeList;
+    Slot* bump;         // Next never-used slot of the newest slab
+    Slot* bumpEnd;
+    int nextSlabSize;
+    int live;
+
+    void addSlab() {
+        void* block = ::operator new(sizeof(Slab) + sizeof(Slot) * (size_t)nextSlabSize);
+        Slab* slab = new (block) Slab;
+        slab->next = slabs;
+        slabs = slab;
+        bump = slab->slots();
+        bumpEnd = bump + nextSlabSize;
+        if (nextSlabSize < NODE_POOL_MAX_SLAB) nextSlabSize *= 2;
+    }
+
+    void reset() {
+        slabs = nullptr;
+        freeList = nullptr;
+        bump = nullptr;
+        bumpEnd = nullptr;
+        nextSlabSize = NODE_POOL_FIRST_SLAB;
+        live = 0;
+    }
+
+public:
+    NodePool() { reset(); }
+
+    // A pool owns the memory of its objects: copying one would alias them
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    NodePool(NodePool&& other) noexcept {
+        reset();
+        swap(other);
+    }
+
+    NodePool& operator=(NodePool&& other) noexcept {
+        if (this != &other) {
+            release();
+            swap(other);
+        }
+        return *this;
+    }
+
+    ~NodePool() {
+        release();
+    }
+
+    template <typename... Args>
+    T* create(Args&&... args) {
+        Slot* slot;
+        if (freeList) {
+            slot = freeList;
+            freeList = freeList->nextFree;
+        }
+        else {
+            if (bump == bumpEnd) addSlab();
+            slot = bump++;
+        }
+
+        T* object;
+        try {
+            object = new (slot->storage) T(std::forward<Args>(args)...);
+        }
+        catch (...) {
+            slot->nextFree = freeList;
+            freeList = slot;
+            throw;
+        }
+        live++;
+        return object;
+    }
+
+    void destroy(T* object) {
+        if (!object) return;
+        object->~T();
+        Slot* slot = reinterpret_cast<Slot*>(object);
+        slot->nextFree = freeList;
+        freeList = slot;
+        live--;
+    }
+
+    // Frees every slab; the objects still in them must not be used afterwards
+    void release() {
+        while (slabs) {
+            Slab* next = slabs->next;
+            ::operator delete(slabs);
+            slabs = next;
+        }
+        reset();
+    }
+
+    int getLiveCount() const { return live; }
+    bool empty() const { return live == 0; }
+
+    void swap(NodePool& other) {
+        std::swap(slabs, other.slabs);
+        std::swap(freeList, other.freeList);
+        std::swap(bump, other.bump);
+        std::swap(bumpEnd, other.bumpEnd);
+        std::swap(nextSlabSize, other.nextSlabSize);
+        std::swap(live, other.live);
+    }
+};
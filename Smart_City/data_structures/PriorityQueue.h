@@ -1,48 +1,55 @@
 #pragma once
 #include <stdexcept>
+#include <utility>
 #include "Vector.h"
 
+// All heaps here are 4-ary min-heaps (the smallest element by operator< is on top): half
+// the depth of a binary heap, and the four children of a node sit next to each other in memory.
+// Sifting carries the moving element in a local and shifts the others into the hole it
+// leaves, so every level costs one move instead of a three-way swap.
+constexpr int HEAP_ARITY = 4;
+
 template <typename T>
 class PriorityQueue {
 private:
     Vector<T> data;
 
     void heapifyUp(int index) {
+        T value = std::move(data[index]);
         while (index > 0) {
-            int parent = (index - 1) / 2;
+            int parent = (index - 1) / HEAP_ARITY;
 
-            if (!(data[index] < data[parent]))
+            if (!(value < data[parent]))
                 break;
 
-            T temp = data[parent];
-            data[parent] = data[index];
-            data[index] = temp;
-
+            data[index] = std::move(data[parent]);
             index = parent;
         }
+        data[index] = std::move(value);
     }
 
     void heapifyDown(int index) {
         int n = data.getSize();
+        T value = std::move(data[index]);
         while (true) {
-            int left = 2 * index + 1;
-            int right = 2 * index + 2;
-            int smallest = index;
+            int first = HEAP_ARITY * index + 1;
+            if (first >= n)
+                break;
 
-            if (left < n && data[left] < data[smallest])
-                smallest = left;
-            if (right < n && data[right] < data[smallest])
-                smallest = right;
+            int last = (first + HEAP_ARITY < n) ? first + HEAP_ARITY : n;
+            int smallest = first;
+            for (int child = first + 1; child < last; child++) {
+                if (data[child] < data[smallest])
+                    smallest = child;
+            }
 
-            if (smallest == index)
+            if (!(data[smallest] < value))
                 break;
 
-            T temp = data[index];
-            data[index] = data[smallest];
-            data[smallest] = temp;
-
+            data[index] = std::move(data[smallest]);
             index = smallest;
         }
+        data[index] = std::move(value);
     }
 
 public:
@@ -73,9 +80,7 @@ public:
     }
 
     void swap(PriorityQueue& other) {
-        Vector<T> temp = data;
-        data = other.data;
-        other.data = temp;
+        data.swap(other.data);
     }
 
     void push(const T& value) {
@@ -83,12 +88,18 @@ public:
         heapifyUp(data.getSize() - 1);
     }
 
+    void push(T&& value) {
+        data.push_back(std::move(value));
+        heapifyUp(data.getSize() - 1);
+    }
+
     void pop() {
         if (empty())
             throw std::runtime_error("PriorityQueue is empty");
 
         int lastIndex = data.getSize() - 1;
-        data[0] = data[lastIndex];
+        if (lastIndex > 0)
+            data[0] = std::move(data[lastIndex]);
         data.pop_back();
 
         if (!data.empty())
@@ -115,3 +126,348 @@ public:
         return data;
     }
 };
+
+
+// Priority queue holding at most one element per index (e.g. one per graph node), for
+// searches that would otherwise push a duplicate every time a node's key improves.
+// IndexOf::index(value) maps an element to its index, any int >= 0; the position table grows
+// to the largest index seen. push() inserts an element or lowers the key of the one already
+// queued under its index; a popped index can be pushed again.
+template <typename T, typename IndexOf>
+class IndexedPriorityQueue {
+private:
+    Vector<T> data;
+    Vector<int> position;   // Index -> slot in data, -1 if not queued
+
+    void place(int slot, T&& value) {
+        position[IndexOf::index(value)] = slot;
+        data[slot] = std::move(value);
+    }
+
+    void heapifyUp(int index) {
+        T value = std::move(data[index]);
+        while (index > 0) {
+            int parent = (index - 1) / HEAP_ARITY;
+
+            if (!(value < data[parent]))
+                break;
+
+            place(index, std::move(data[parent]));
+            index = parent;
+        }
+        place(index, std::move(value));
+    }
+
+    void heapifyDown(int index) {
+        int n = data.getSize();
+        T value = std::move(data[index]);
+        while (true) {
+            int first = HEAP_ARITY * index + 1;
+            if (first >= n)
+                break;
+
+            int last = (first + HEAP_ARITY < n) ? first + HEAP_ARITY : n;
+            int smallest = first;
+            for (int child = first + 1; child < last; child++) {
+                if (data[child] < data[smallest])
+                    smallest = child;
+            }
+
+            if (!(data[smallest] < value))
+                break;
+
+            place(index, std::move(data[smallest]));
+            index = smallest;
+        }
+        place(index, std::move(value));
+    }
+
+    int slotOf(int index) const {
+        return (index >= 0 && index < position.getSize()) ? position[index] : -1;
+    }
+
+public:
+    IndexedPriorityQueue() : data(), position() {}
+
+    bool empty() const {
+        return data.empty();
+    }
+
+    int size() const {
+        return data.getSize();
+    }
+
+    // Only the queued indices are reset, so clearing costs the queue's size, not the index range
+    void clear() {
+        for (int i = 0; i < data.getSize(); i++)
+            position[IndexOf::index(data[i])] = -1;
+        data.clear();
+    }
+
+    // Makes indices [0, count) addressable without growing the position table later
+    void reserveIndices(int count) {
+        if (count > position.getSize())
+            position.resize(count, -1);
+    }
+
+    bool contains(int index) const {
+        return slotOf(index) != -1;
+    }
+
+    // Inserts value, or replaces the element queued under its index if value is smaller.
+    // Returns false (and changes nothing) if the queued element is not larger.
+    bool push(const T& value) {
+        int index = IndexOf::index(value);
+        int slot = slotOf(index);
+        if (slot != -1) {
+            if (!(value < data[slot]))
+                return false;
+            data[slot] = value;
+            heapifyUp(slot);
+            return true;
+        }
+
+        if (index >= position.getSize()) {
+            int grown = position.getSize() * 2;
+            position.resize(grown > index ? grown : index + 1, -1);
+        }
+        data.push_back(value);
+        heapifyUp(data.getSize() - 1);
+        return true;
+    }
+
+    // Like push(), but only for an index that is already queued
+    bool decreaseKey(const T& value) {
+        if (!contains(IndexOf::index(value)))
+            return false;
+        return push(value);
+    }
+
+    void pop() {
+        if (empty())
+            throw std::runtime_error("PriorityQueue is empty");
+
+        position[IndexOf::index(data[0])] = -1;
+        int lastIndex = data.getSize() - 1;
+        if (lastIndex > 0)
+            data[0] = std::move(data[lastIndex]);
+        data.pop_back();
+
+        if (!data.empty())
+            heapifyDown(0);
+    }
+
+    const T& top() const {
+        if (empty())
+            throw std::out_of_range("PriorityQueue is empty");
+        return data[0];
+    }
+
+    // The elements in heap order (read-only: the position table must stay in step)
+    const Vector<T>& getVector() const {
+        return data;
+    }
+
+    // Shrinking policy of the element storage (see Vector::setAutoShrink)
+    void setAutoShrink(bool enabled) {
+        data.setAutoShrink(enabled);
+    }
+};
+
+
+// Priority queue for payloads that are expensive to move (records full of strings): the
+// payloads stay in place and the heap sifts (key, handle) pairs only. push() returns a
+// handle that identifies the element until it is popped or removed, so its priority can be
+// changed or the element withdrawn while it waits.
+// Smaller keys come out first; equal keys come out in the order they were pushed.
+// A popped payload's slot is recycled by a later push, and freed slots keep their old
+// payload until then (clear() releases them all).
+template <typename T, typename Key = int>
+class HandlePriorityQueue {
+private:
+    struct Entry {
+        Key key;
+        unsigned long long order;   // Push sequence number, for first-in-first-out ties
+        int handle;
+
+        bool operator<(const Entry& other) const {
+            if (key < other.key) return true;
+            if (other.key < key) return false;
+            return order < other.order;
+        }
+    };
+
+    Vector<Entry> heap;
+    Vector<T> payload;          // Handle -> element
+    Vector<int> position;       // Handle -> slot in heap, -1 if free
+    Vector<int> freeHandles;
+    unsigned long long pushed;
+
+    void place(int slot, const Entry& entry) {
+        heap[slot] = entry;
+        position[entry.handle] = slot;
+    }
+
+    void heapifyUp(int index) {
+        Entry entry = heap[index];
+        while (index > 0) {
+            int parent = (index - 1) / HEAP_ARITY;
+
+            if (!(entry < heap[parent]))
+                break;
+
+            place(index, heap[parent]);
+            index = parent;
+        }
+        place(index, entry);
+    }
+
+    void heapifyDown(int index) {
+        int n = heap.getSize();
+        Entry entry = heap[index];
+        while (true) {
+            int first = HEAP_ARITY * index + 1;
+            if (first >= n)
+                break;
+
+            int last = (first + HEAP_ARITY < n) ? first + HEAP_ARITY : n;
+            int smallest = first;
+            for (int child = first + 1; child < last; child++) {
+                if (heap[child] < heap[smallest])
+                    smallest = child;
+            }
+
+            if (!(heap[smallest] < entry))
+                break;
+
+            place(index, heap[smallest]);
+            index = smallest;
+        }
+        place(index, entry);
+    }
+
+    // Takes the entry in slot out of the heap
+    void removeSlot(int slot) {
+        int handle = heap[slot].handle;
+        position[handle] = -1;
+        freeHandles.push_back(handle);
+
+        int lastIndex = heap.getSize() - 1;
+        if (slot != lastIndex) {
+            // The last entry fills the hole and may belong above or below it
+            int moved = heap[lastIndex].handle;
+            place(slot, heap[lastIndex]);
+            heap.pop_back();
+            heapifyUp(slot);
+            heapifyDown(position[moved]);
+        }
+        else {
+            heap.pop_back();
+        }
+    }
+
+    void checkHandle(int handle) const {
+        if (!contains(handle))
+            throw std::out_of_range("Invalid priority queue handle");
+    }
+
+public:
+    HandlePriorityQueue() : pushed(0) {}
+
+    bool empty() const {
+        return heap.empty();
+    }
+
+    int size() const {
+        return heap.getSize();
+    }
+
+    void clear() {
+        heap.clear();
+        payload.clear();
+        position.clear();
+        freeHandles.clear();
+    }
+
+    int push(const T& value, const Key& key) {
+        int handle;
+        if (!freeHandles.empty()) {
+            handle = freeHandles.back();
+            freeHandles.pop_back();
+            payload[handle] = value;
+        }
+        else {
+            handle = payload.getSize();
+            payload.push_back(value);
+            position.push_back(-1);
+        }
+
+        Entry entry;
+        entry.key = key;
+        entry.order = pushed++;
+        entry.handle = handle;
+        heap.push_back(entry);
+        position[handle] = heap.getSize() - 1;
+        heapifyUp(heap.getSize() - 1);
+        return handle;
+    }
+
+    void pop() {
+        if (empty())
+            throw std::runtime_error("PriorityQueue is empty");
+        removeSlot(0);
+    }
+
+    T& top() {
+        if (empty())
+            throw std::out_of_range("PriorityQueue is empty");
+        return payload[heap[0].handle];
+    }
+
+    const T& top() const {
+        if (empty())
+            throw std::out_of_range("PriorityQueue is empty");
+        return payload[heap[0].handle];
+    }
+
+    int topHandle() const {
+        if (empty())
+            throw std::out_of_range("PriorityQueue is empty");
+        return heap[0].handle;
+    }
+
+    bool contains(int handle) const {
+        return handle >= 0 && handle < position.getSize() && position[handle] != -1;
+    }
+
+    T& get(int handle) {
+        checkHandle(handle);
+        return payload[handle];
+    }
+
+    const T& get(int handle) const {
+        checkHandle(handle);
+        return payload[handle];
+    }
+
+    const Key& getKey(int handle) const {
+        checkHandle(handle);
+        return heap[position[handle]].key;
+    }
+
+    // Moves the element to its new place; its order among equal keys stays that of its push
+    void setKey(int handle, const Key& key) {
+        checkHandle(handle);
+        int slot = position[handle];
+        heap[slot].key = key;
+        heapifyUp(slot);
+        heapifyDown(position[handle]);
+    }
+
+    bool remove(int handle) {
+        if (!contains(handle))
+            return false;
+        removeSlot(position[handle]);
+        return true;
+    }
+};
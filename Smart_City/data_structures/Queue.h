@@ -1,85 +1,118 @@
 #pragma once
-#include "LinkedLists.h"
+#include "RingBuffer.h"
+#include "Vector.h"
 #include <stdexcept>
 
 template <typename T>
 class Queue {
 private:
-    LinkedList<T> list;
+    RingBuffer<T> buffer;
 
 public:
-    Queue() : list() {}
+    Queue() : buffer() {}
 
-    Queue(const Queue& other) : list(other.list) {}
+    Queue(const Queue& other) : buffer(other.buffer) {}
+
+    Queue(Queue&& other) noexcept : buffer(std::move(other.buffer)) {}
 
     Queue& operator=(const Queue& other) {
         if (this != &other)
-            list = other.list;
+            buffer = other.buffer;
+        return *this;
+    }
+
+    Queue& operator=(Queue&& other) noexcept {
+        if (this != &other)
+            buffer = std::move(other.buffer);
         return *this;
     }
 
     ~Queue() = default;
 
     void push(const T& value) {
-        list.push_back(value);
+        buffer.emplace_back(value);
+    }
+
+    void push(T&& value) {
+        buffer.emplace_back(std::move(value));
     }
 
     void pop() {
         if (empty())
             throw std::runtime_error("Queue is empty");
-        list.pop_front();
+        buffer.pop_front();
+    }
+
+    // Removes the front element and returns it by move
+    T take() {
+        if (empty())
+            throw std::runtime_error("Queue is empty");
+        return buffer.take_front();
+    }
+
+    // Moves up to n front elements to the end of out, in queue order; returns how many
+    int drain(int n, Vector<T>& out) {
+        int moved = 0;
+        while (moved < n && !empty()) {
+            out.emplace_back(std::move(buffer[0]));
+            buffer.pop_front();
+            moved++;
+        }
+        return moved;
     }
 
     T& front() {
-        return list.front();
+        if (empty())
+            throw std::runtime_error("Queue is empty");
+        return buffer[0];
     }
 
     const T& front() const {
-        return list.front();
+        if (empty())
+            throw std::runtime_error("Queue is empty");
+        return buffer[0];
     }
 
     T& back() {
-        return list.back();
+        if (empty())
+            throw std::runtime_error("Queue is empty");
+        return buffer[buffer.size() - 1];
     }
 
     const T& back() const {
-        return list.back();
+        if (empty())
+            throw std::runtime_error("Queue is empty");
+        return buffer[buffer.size() - 1];
     }
 
     bool empty() const {
-        return list.empty();
+        return buffer.empty();
     }
 
     int size() const {
-        return list.getSize();
+        return buffer.size();
     }
 
+    // Keeps the buffer for refilling
     void clear() {
-        list.clear();
+        buffer.clear();
     }
 
     void swap(Queue& other) {
-        list.swap(other.list);
+        buffer.swap(other.buffer);
     }
 
     int find(const T& value) const {
-        return list.find(value);
+        return buffer.find(value);
     }
 
     bool contains(const T& value) const {
-        return list.contains(value);
+        return buffer.find(value) != -1;
     }
 
     void remove(const T& value) {
-        list.remove(value);
-    }
-
-    LinkedList<T>& getList() {
-        return list;
-    }
-
-    const LinkedList<T>& getList() const {
-        return list;
+        int index = buffer.find(value);
+        if (index != -1)
+            buffer.erase(index);
     }
 };
-
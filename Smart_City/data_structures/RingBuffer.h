@@ -0,0 +1,179 @@
+#pragma once
+#include <stdexcept>
+#include <new>
+#include <utility>
+
+// Contiguous FIFO storage behind Queue and CircularQueue. The elements occupy count
+// consecutive slots starting at head and wrap around the end of the buffer; the slot count
+// is a power of two, so wrapping is a mask. The buffer only grows (doubling): a queue that
+// keeps cycling around the same length stops allocating once it has reached it.
+// Only occupied slots hold constructed elements.
+template <typename T>
+class RingBuffer {
+private:
+    T* slots;
+    int bufferSize;     // 0 or a power of two
+    int head;
+    int count;
+
+    T* slot(int index) const {
+        return slots + ((head + index) & (bufferSize - 1));
+    }
+
+    static T* allocate(int n) {
+        return static_cast<T*>(::operator new(sizeof(T) * (size_t)n));
+    }
+
+    // Moves the elements to the start of a new buffer of newSize slots
+    void relocate(T* newSlots, int newSize) {
+        for (int i = 0; i < count; i++) {
+            T* old = slot(i);
+            new (newSlots + i) T(std::move(*old));
+            old->~T();
+        }
+        ::operator delete(slots);
+        slots = newSlots;
+        bufferSize = newSize;
+        head = 0;
+    }
+
+    static int roundUp(int n) {
+        int size = 4;
+        while (size < n) size *= 2;
+        return size;
+    }
+
+public:
+    RingBuffer() : slots(nullptr), bufferSize(0), head(0), count(0) {}
+
+    RingBuffer(const RingBuffer& other) : slots(nullptr), bufferSize(0), head(0), count(0) {
+        if (other.count == 0) return;
+        bufferSize = roundUp(other.count);
+        slots = allocate(bufferSize);
+        for (int i = 0; i < other.count; i++) {
+            new (slots + i) T(*other.slot(i));
+            count++;
+        }
+    }
+
+    RingBuffer(RingBuffer&& other) noexcept
+        : slots(other.slots), bufferSize(other.bufferSize), head(other.head), count(other.count) {
+        other.slots = nullptr;
+        other.bufferSize = 0;
+        other.head = 0;
+        other.count = 0;
+    }
+
+    RingBuffer& operator=(const RingBuffer& other) {
+        if (this == &other) return *this;
+        RingBuffer copy(other);
+        swap(copy);
+        return *this;
+    }
+
+    RingBuffer& operator=(RingBuffer&& other) noexcept {
+        if (this == &other) return *this;
+        RingBuffer moved(std::move(other));
+        swap(moved);
+        return *this;
+    }
+
+    ~RingBuffer() {
+        clear();
+        ::operator delete(slots);
+    }
+
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    int getBufferSize() const { return bufferSize; }
+
+    // Unchecked: index must be in [0, size())
+    T& operator[](int index) { return *slot(index); }
+    const T& operator[](int index) const { return *slot(index); }
+
+    // Constructs the element in place; args may refer to an element of this buffer
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (count == bufferSize) {
+            int newSize = (bufferSize == 0) ? 4 : bufferSize * 2;
+            T* newSlots = allocate(newSize);
+            // Build the new element first: args may point into the old buffer
+            new (newSlots + count) T(std::forward<Args>(args)...);
+            relocate(newSlots, newSize);
+        }
+        else {
+            new (slot(count)) T(std::forward<Args>(args)...);
+        }
+        return *slot(count++);
+    }
+
+    // Moves the front element out
+    T take_front() {
+        T value(std::move(*slot(0)));
+        pop_front();
+        return value;
+    }
+
+    void pop_front() {
+        slot(0)->~T();
+        head = (head + 1) & (bufferSize - 1);
+        count--;
+    }
+
+    void pop_back() {
+        slot(count - 1)->~T();
+        count--;
+    }
+
+    // Destroys the elements; the buffer is kept for refilling
+    void clear() {
+        for (int i = 0; i < count; i++)
+            slot(i)->~T();
+        head = 0;
+        count = 0;
+    }
+
+    void reserve(int n) {
+        if (n > bufferSize) relocate(allocate(roundUp(n)), roundUp(n));
+    }
+
+    // Moves the front element to the back n times (backwards for negative n)
+    void rotate(int n) {
+        if (count <= 1) return;
+        n %= count;
+        if (n < 0) n += count;
+        if (n == 0) return;
+
+        if (count == bufferSize) {
+            head = (head + n) & (bufferSize - 1);
+            return;
+        }
+        for (int i = 0; i < n; i++) {
+            // There is a free slot behind the back, so nothing reallocates
+            new (slot(count)) T(std::move(*slot(0)));
+            pop_front();
+            count++;
+        }
+    }
+
+    int find(const T& value) const {
+        for (int i = 0; i < count; i++) {
+            if (*slot(i) == value) return i;
+        }
+        return -1;
+    }
+
+    // Removes the element at index, closing the gap from behind
+    void erase(int index) {
+        for (int i = index; i < count - 1; i++)
+            *slot(i) = std::move(*slot(i + 1));
+        pop_back();
+    }
+
+    void swap(RingBuffer& other) {
+        std::swap(slots, other.slots);
+        std::swap(bufferSize, other.bufferSize);
+        std::swap(head, other.head);
+        std::swap(count, other.count);
+    }
+};
@@ -1,76 +1,93 @@
 #pragma once
-#include "LinkedLists.h"
+#include "Vector.h"
 #include <stdexcept>
 
+// Array-backed: the top is the back of the vector. Indices from find() count from the top.
 template <typename T>
 class Stack {
 private:
-    LinkedList<T> list;
+    Vector<T> items;
 
 public:
-    Stack() : list() {}
+    Stack() : items() {}
 
-    Stack(const Stack& other) : list(other.list) {}
+    Stack(const Stack& other) : items(other.items) {}
+
+    Stack(Stack&& other) noexcept : items(std::move(other.items)) {}
 
     Stack& operator=(const Stack& other) {
         if (this != &other)
-            list = other.list;
+            items = other.items;
+        return *this;
+    }
+
+    Stack& operator=(Stack&& other) noexcept {
+        if (this != &other)
+            items = std::move(other.items);
         return *this;
     }
 
     ~Stack() = default;
 
     void push(const T& value) {
-        list.push_front(value);
+        items.push_back(value);
+    }
+
+    void push(T&& value) {
+        items.push_back(std::move(value));
     }
 
     void pop() {
         if (empty())
             throw std::runtime_error("Stack is empty");
-        list.pop_front();
+        items.pop_back();
     }
 
     T& top() {
-        return list.front();
+        if (empty())
+            throw std::runtime_error("Stack is empty");
+        return items.back();
     }
 
     const T& top() const {
-        return list.front();
+        if (empty())
+            throw std::runtime_error("Stack is empty");
+        return items.back();
     }
 
     bool empty() const {
-        return list.empty();
+        return items.empty();
     }
 
     int size() const {
-        return list.getSize();
+        return items.getSize();
     }
 
+    // Keeps the storage for refilling
     void clear() {
-        list.clear();
+        items.clear();
     }
 
     void swap(Stack& other) {
-        list.swap(other.list);
+        items.swap(other.items);
     }
 
     int find(const T& value) const {
-        return list.find(value);
+        for (int i = items.getSize() - 1; i >= 0; i--) {
+            if (items[i] == value)
+                return items.getSize() - 1 - i;
+        }
+        return -1;
     }
 
     bool contains(const T& value) const {
-        return list.contains(value);
+        return find(value) != -1;
     }
 
+    // Removes the occurrence nearest the top
     void remove(const T& value) {
-        list.remove(value);
-    }
-
-    LinkedList<T>& getList() {
-        return list;
-    }
-
-    const LinkedList<T>& getList() const {
-        return list;
+        int depth = find(value);
+        if (depth != -1)
+            items.erase(items.getSize() - 1 - depth);
     }
 };
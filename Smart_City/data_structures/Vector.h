@@ -1,72 +1,127 @@
 #pragma once
 #include <stdexcept>
-
-
+#include <new>
+#include <utility>
+
+// operator[] is bounds-checked in debug builds only (at() always is). Define
+// VECTOR_BOUNDS_CHECK as 1 to keep the check in release builds as well.
+#ifndef VECTOR_BOUNDS_CHECK
+#ifdef NDEBUG
+#define VECTOR_BOUNDS_CHECK 0
+#else
+#define VECTOR_BOUNDS_CHECK 1
+#endif
+#endif
+
+
+// Elements live in raw storage: only [0, size) is constructed, so growing never
+// default-constructs spare slots, and elements are moved (not copied) when the storage moves.
 template <typename T>
 class Vector {
     T* data;
     int size;
     int capacity;
+    bool autoShrink;
 
 public:
-    Vector(int s = 0) : data(nullptr), size(0), capacity(s) {
+    // s is the initial capacity; the vector starts empty
+    Vector(int s = 0) : data(nullptr), size(0), capacity(0), autoShrink(true) {
         if (s < 0)
             throw std::invalid_argument("Invalid size");
 
-        if (capacity > 0)
-            data = new T[capacity];
+        if (s > 0)
+            reallocate(s);
     }
 
     Vector(const Vector& other)
-        : data(nullptr), size(other.size), capacity(other.capacity) {
-        if (capacity > 0) {
-            data = new T[capacity];
-            for (int i = 0; i < size; i++)
-                data[i] = other.data[i];
+        : data(nullptr), size(0), capacity(0), autoShrink(other.autoShrink) {
+        if (other.size > 0) {
+            data = allocate(other.size);
+            capacity = other.size;
+            for (int i = 0; i < other.size; i++)
+                new (data + i) T(other.data[i]);
+            size = other.size;
         }
-	}
+    }
+
+    Vector(Vector&& other) noexcept
+        : data(other.data), size(other.size), capacity(other.capacity), autoShrink(other.autoShrink) {
+        other.data = nullptr;
+        other.size = 0;
+        other.capacity = 0;
+    }
 
     Vector& operator=(const Vector& other) {
         if (this == &other)
             return *this;
-        delete[] data;
+        Vector copy(other);
+        swap(copy);
+        return *this;
+    }
+
+    Vector& operator=(Vector&& other) noexcept {
+        if (this == &other)
+            return *this;
+        destroyAll();
+        deallocate(data);
+        data = other.data;
         size = other.size;
         capacity = other.capacity;
-        data = nullptr;
-        if (capacity > 0) {
-            data = new T[capacity];
-            for (int i = 0; i < size; i++)
-                data[i] = other.data[i];
-        }
+        autoShrink = other.autoShrink;
+        other.data = nullptr;
+        other.size = 0;
+        other.capacity = 0;
         return *this;
-	}
+    }
 
     ~Vector() {
-        delete[] data;
+        destroyAll();
+        deallocate(data);
     }
 
     void push_back(const T& obj) {
+        emplace_back(obj);
+    }
+
+    void push_back(T&& obj) {
+        emplace_back(std::move(obj));
+    }
+
+    // Constructs the element in place; args may refer to an element of this vector
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
         if (size == capacity) {
             int newCap = (capacity == 0) ? 1 : capacity * 2;
-            reallocate(newCap);
+            T* newData = allocate(newCap);
+            // Build the new element first: args may point into the old storage
+            new (newData + size) T(std::forward<Args>(args)...);
+            moveInto(newData);
+            data = newData;
+            capacity = newCap;
+        }
+        else {
+            new (data + size) T(std::forward<Args>(args)...);
         }
-        data[size++] = obj;
+        return data[size++];
     }
 
     // Begin and end
 
 	T* begin() { return data; }
 	T* end() { return data + size; }
+	const T* begin() const { return data; }
+	const T* end() const { return data + size; }
 
     void push_front(const T& obj) {
-        if (size == capacity) {
-            int newCap = (capacity == 0) ? 1 : capacity * 2;
-            reallocate(newCap);
+        T value(obj);   // obj may be an element of this vector
+        if (size == 0) {
+            emplace_back(std::move(value));
+            return;
         }
-        for (int i = size; i > 0; i--)
-            data[i] = data[i - 1];
-        data[0] = obj;
-        size++;
+        emplace_back(std::move(data[size - 1]));
+        for (int i = size - 2; i > 0; i--)
+            data[i] = std::move(data[i - 1]);
+        data[0] = std::move(value);
 	}
 
     T& at(int index) {
@@ -82,14 +137,18 @@ public:
     }
 
     T& operator[](int index) {
+#if VECTOR_BOUNDS_CHECK
         if (index < 0 || index >= size)
             throw std::out_of_range("Index out of range");
+#endif
         return data[index];
     }
 
     const T& operator[](int index) const {
+#if VECTOR_BOUNDS_CHECK
         if (index < 0 || index >= size)
             throw std::out_of_range("Index out of range");
+#endif
         return data[index];
     }
 
@@ -120,7 +179,7 @@ public:
     void pop_back() {
         if (size == 0)
             return;
-        size--;
+        data[--size].~T();
         shrinkCheck();
     }
 
@@ -128,8 +187,8 @@ public:
         if (size == 0)
             return;
         for (int i = 0; i < size - 1; i++)
-            data[i] = data[i + 1];
-        size--;
+            data[i] = std::move(data[i + 1]);
+        data[--size].~T();
         shrinkCheck();
 	}
 
@@ -142,32 +201,46 @@ public:
         if (newSize < 0)
             throw std::invalid_argument("Invalid size");
         if (newSize < size) {
-            size = newSize;
-            shrinkCheck();  
+            while (size > newSize)
+                data[--size].~T();
+            shrinkCheck();
         }
-        else if (newSize > size) { 
-            if (newSize > capacity)
+        else if (newSize > size) {
+            if (newSize > capacity) {
+                T value(defVal);    // defVal may be an element of this vector
                 reallocate(newSize);
-            for (int i = size; i < newSize; i++)
-                data[i] = defVal;
-            size = newSize;
+                fill(newSize, value);
+            }
+            else {
+                fill(newSize, defVal);
+            }
         }
     }
     bool empty() const { return size == 0; }
 
+    // Keeps the storage for refilling (see shrink_to_fit)
     void clear() {
-        size = 0;
-        shrinkCheck();
+        destroyAll();
+    }
+
+    // Releases spare capacity
+    void shrink_to_fit() {
+        if (capacity == size)
+            return;
+        if (size == 0) {
+            deallocate(data);
+            data = nullptr;
+            capacity = 0;
+            return;
+        }
+        reallocate(size);
     }
 
     void swap(Vector& other) {
-        T* tempData = data;
-        int tempSize = size;
-        int tempCapacity = capacity;
-        data = other.data;
-        size = other.size;
-        capacity = other.capacity;
-        other.data = tempData;
+        std::swap(data, other.data);
+        std::swap(size, other.size);
+        std::swap(capacity, other.capacity);
+        std::swap(autoShrink, other.autoShrink);
     }
 
     int find(const T& value) const {
@@ -185,41 +258,70 @@ public:
     void remove(const T& value) {
         int idx = find(value);
         if (idx == -1) return;
-        for (int i = idx; i < size - 1; ++i) {
-            data[i] = data[i + 1];
-        }
-        --size;
-        shrinkCheck();
+        erase(idx);
     }
 
     void erase(int index) {
         if (index < 0 || index >= size)
             throw std::out_of_range("Index out of range");
         for (int i = index; i < size - 1; i++)
-            data[i] = data[i + 1];
-        size--;
+            data[i] = std::move(data[i + 1]);
+        data[--size].~T();
         shrinkCheck();
 	}
 
     int getSize() const { return size; }
     int getCapacity() const { return capacity; }
 
+    // Shrinking policy for pop_back / pop_front / erase / remove / resize: with autoShrink on
+    // (the default) the storage halves once it is at most a quarter full; off keeps it
+    // (for scratch buffers refilled on every use)
+    void setAutoShrink(bool enabled) { autoShrink = enabled; }
+
 private:
-    void reallocate(int newCap) {
-        T* newData = new T[newCap];
+    static T* allocate(int cap) {
+        return static_cast<T*>(::operator new(sizeof(T) * (size_t)cap));
+    }
+
+    static void deallocate(T* block) {
+        ::operator delete(block);
+    }
+
+    void destroyAll() {
         for (int i = 0; i < size; i++)
-            newData[i] = data[i];
-        delete[] data;
+            data[i].~T();
+        size = 0;
+    }
+
+    // Moves the elements into newData and frees the old storage
+    void moveInto(T* newData) {
+        for (int i = 0; i < size; i++) {
+            new (newData + i) T(std::move(data[i]));
+            data[i].~T();
+        }
+        deallocate(data);
+    }
+
+    void reallocate(int newCap) {
+        T* newData = allocate(newCap);
+        moveInto(newData);
         data = newData;
         capacity = newCap;
 	}
 
+    void fill(int newSize, const T& value) {
+        while (size < newSize) {
+            new (data + size) T(value);
+            size++;
+        }
+    }
+
+    // Halving at a quarter (not a half) leaves the shrunk storage half full, so a push/pop
+    // cycle around any size never reallocates on every step
     void shrinkCheck() {
-        if (capacity > 4 && size <= capacity / 3) {
-            int newCap = capacity / 2;
-            if (newCap < 1) newCap = 1;
-            reallocate(newCap);
+        if (!autoShrink) return;
+        if (capacity > 16 && size <= capacity / 4) {
+            reallocate(capacity / 2);
         }
     }
 };
-
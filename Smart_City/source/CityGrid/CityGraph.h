@@ -1,20 +1,134 @@
 #pragma once
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <thread>
 #include "CityUtils.h"
+#include "ContractionHierarchy.h"
+#include "FacilityIndex.h"
+#include "IncrementalRouter.h"
+#include "RouteCache.h"
+#include "SectorDistanceTable.h"
+#include "SectorOverlay.h"
+#include "SpatialGrid.h"
+#include "TrafficProfile.h"
 
 class CityGraph {
 private:
-    CityNode* nodes[MAX_NODES];
+    // Node store: grows on demand. Searches read the contiguous hot arrays below; the
+    // CityNode records (strings, road lists) are only touched by lookups and editing.
+    Vector<CityNode*> nodes;
     int nodeCount;
+    NodePool<CityNode> nodePool;    // Storage of every CityNode; the graph frees it a slab at once
 
-    int facilityCounters[14];
+    Vector<double> nodeLat;
+    Vector<double> nodeLon;
+    Vector<int> nodeSector;     // SECTOR_GRID index of CityNode::sector (-1 outside every sector)
+    Vector<int> nodeType;       // CityNode::typeID
+
+    int facilityCounters[FacilityType::COUNTER_COUNT];
+
+    // Node lookups by key; the lowest node ID wins when several nodes share a key
+    HashTable<string, int> nameIndex;
+    HashTable<string, int> databaseIDIndex;
+    HashTable<string, int> stopIDIndex;
+
+    // Contiguous adjacency mirror of every node's road list (searched instead of the lists)
+    RoadCSR csr;
+
+    // Point-to-point routing
+    RouteSearchMode defaultSearchMode;
+    double minWeightPerKm;  // Smallest edge weight / straight-line length; scales the A* heuristic
+
+    // Static-weight shortcut index; any road change marks it stale and HIERARCHY queries rebuild it
+    ContractionHierarchy hierarchy;
+
+    // Sector-level two-level routing data; rebuilt on road changes, re-customized on traffic updates
+    SectorOverlay overlay;
+
+    // Centre-to-centre static distances between all sectors; any road change marks it stale
+    // and the next lookup recomputes it
+    SectorDistanceTable sectorDistances;
+
+    // Node positions bucketed by location (positions never change once a node exists)
+    SpatialGrid nodeGrid;
+
+    // Per-type nearest-facility labels, built on first lookup of a type and repaired on every change
+    NearestFacilityIndex facilityIndex;
+    void ensureFacilityIndex(int typeID);
+
+    // Recently answered point-to-point routes (both metrics)
+    RouteCache routeCache;
+
+    // Long-lived dynamic-metric routes (one per travelling vehicle), repaired on traffic flushes
+    IncrementalRouter router;
+
+    // Origin node of every edge ID ever assigned (IDs are never reused)
+    Vector<int> edgeOrigins;
+
+    // Load of every road by time of day, learned while the traffic clock runs
+    TrafficProfile trafficProfile;
+    double predictWeight(const Edge* edge, double minutesAhead) const;
+
+    // findAlternativeRoutes scratch, kept between calls: penalized weights per CSR slot, the
+    // kept routes driving each slot (one bit each) and the slots whose bits are set
+    Vector<double> alternativeWeights;
+    Vector<unsigned int> alternativeMask;
+    Vector<int> alternativeMasked;
+
+    // IDs of edges whose load changed since their weight was last recomputed
+    Vector<int> dirtyEdges;
+    bool coalesceTraffic;   // Defer flushing from updateTrafficWeights to the next dynamic query
+    bool trafficUnpublished;    // CSR weights changed, overlay and route cache not told yet
+    void markTrafficDirty(Edge* edge);
+    void applyTrafficWeights();
+    void flushTrafficUpdates();
 
     // Internal helper to create a node structure without triggering grid logic
     // Used for creating the skeleton (CORNER) nodes
     int createNodeRaw(const string& dbID, const string& sID, const string& name, const string& type, double lat, double lon);
 
+    // Appends a directed road to both the node's list and its CSR row; returns its edge ID
+    int pushRoad(int fromNode, const Edge& edge);
+    void linkReverseEdges(int forwardID, int backwardID);
+
     // Snaps a node position to a logical place within its SubSubSector cell
     void snapNodePosition(const SubSubSector* cell, int nodeIndex, double& lat, double& lon);
 
+    // Point-to-point searches over one of the CSR weight arrays (static or dynamic)
+    Vector<int> searchPath(int startID, int endID, double& totalDistance, const double* weights, RouteSearchMode mode);
+    Vector<int> runSearch(int startID, int endID, double& totalDistance, const double* weights, RouteSearchMode mode);
+    Vector<int> searchDijkstra(int startID, int endID, double& totalDistance, const double* weights, bool useHeuristic);
+    Vector<int> searchBidirectional(int startID, int endID, double& totalDistance, const double* weights);
+    Vector<int> searchOverlay(int startID, int endID, double& totalDistance, const double* weights);
+    double estimateDistance(int fromID, int toID) const;
+
+    // Shared body of distanceMatrix / distanceMatrixDynamic
+    Vector<double> computeDistanceMatrix(const Vector<int>& sources, const Vector<int>& targets,
+        const double* weights, int threadCount);
+    // One-to-many Dijkstra that stops once every node flagged in isTarget is settled
+    void searchToTargets(int sourceID, const Vector<unsigned char>& isTarget, int targetCount,
+        const double* weights, SearchWorkspace& ws) const;
+    // Runs task(i) for i in [0, count) on up to threadCount threads (0 = all hardware threads)
+    template <typename Task>
+    static void runParallel(int count, int threadCount, Task task);
+
+    // Trip table grouped by origin for assignTraffic: origin i sends tripVolume[k] vehicles
+    // to tripDestination[k] for k in [tripStart[i], tripStart[i + 1])
+    struct OriginTrips {
+        Vector<int> origins;
+        Vector<int> tripStart;
+        Vector<int> tripDestination;
+        Vector<double> tripVolume;
+    };
+    // Routes every trip on its shortest path under costs (per CSR slot) and returns the
+    // resulting per-slot flows; trips with no path are added to unrouted
+    Vector<double> assignAllOrNothing(const OriginTrips& trips, const double* costs, int threadCount,
+        double& unrouted) const;
+
+    // Per-thread search scratch; slot 1 is only used by the second half of two-sided searches
+    static SearchWorkspace& getWorkspace(int slot = 0);
+
 public:
     CityGraph();
     ~CityGraph();
@@ -25,6 +139,12 @@ public:
     CityNode* getNode(int index) const;
     int getNodeCount() const { return nodeCount; }
 
+    // Hot per-node fields without dereferencing the CityNode (index must be valid)
+    double getNodeLat(int index) const { return nodeLat[index]; }
+    double getNodeLon(int index) const { return nodeLon[index]; }
+    int getNodeSectorIndex(int index) const { return nodeSector[index]; }
+    int getNodeTypeID(int index) const { return nodeType[index]; }
+
     int addLocation(const string& databaseID, const string& stopID,
         const string& name, const string& type, double lat, double lon);
     int addPublicFacility(const string& name, const string& type, const string& sector);
@@ -50,23 +170,147 @@ public:
     Edge* getEdge(int fromNode, int toNode);
     const Edge* getEdge(int fromNode, int toNode) const;
 
+    // ==================== EDGE HANDLES ====================
+    // Every directed road gets a dense ID when it is added. IDs are never reused, so a
+    // handle held across a removeRoad simply stops resolving (getEdgeByID returns nullptr).
+    int getEdgeID(int fromNode, int toNode) const;          // -1 if there is no such road
+    Edge* getEdgeByID(int edgeID);
+    const Edge* getEdgeByID(int edgeID) const;
+    int getReverseEdgeID(int edgeID) const;
+    int getEdgeOrigin(int edgeID) const;
+    bool isEdgeBetween(int edgeID, int fromNode, int toNode) const;
+    int getEdgeIDCount() const { return edgeOrigins.getSize(); }
+    Vector<int> getPathEdgeIDs(const Vector<int>& path) const;  // One ID per hop (-1 for a missing road)
+
     // ==================== TRAFFIC MANAGEMENT ====================
     // Try to enter a road segment. Returns true if successful, false if road is full.
+    bool tryEnterEdge(int edgeID);
     bool tryEnterEdge(int fromNode, int toNode);
     
     // Leave a road segment, decreasing its load
+    void leaveEdge(int edgeID);
     void leaveEdge(int fromNode, int toNode);
     
-    // Update all dynamic weights based on current traffic loads
+    // Recompute dynamic weights of the roads whose load changed since the last update
+    // (with coalescing on, this is deferred until the next dynamic-weight query)
     void updateTrafficWeights();
+    void setTrafficCoalescing(bool enabled);
+    bool isTrafficCoalescing() const { return coalesceTraffic; }
+    int getPendingTrafficUpdates() const { return dirtyEdges.getSize(); }
     
     // Get traffic statistics
+    double getEdgeCongestion(int edgeID) const;
     double getEdgeCongestion(int fromNode, int toNode) const;
     int getTotalVehiclesOnRoads() const;
 
+    // ==================== TRAFFIC ASSIGNMENT ====================
+    // Static user equilibrium of a trip table (Frank-Wolfe): every trip ends up on a route no
+    // costlier than any alternative under the congestion cost of Edge::updateDynamicWeight.
+    // Each round's all-or-nothing searches run on threadCount threads (0 = all hardware threads).
+    // Roads and live traffic are left untouched.
+    TrafficAssignmentResult assignTraffic(const Vector<TripDemand>& demand, int threadCount = 0,
+        int maxIterations = TRAFFIC_ASSIGNMENT_MAX_ITERATIONS, double gapTolerance = TRAFFIC_ASSIGNMENT_GAP);
+    // Seeds Edge::currentLoad (rounded, capped at capacity) and the dynamic weights from a result
+    void applyTrafficAssignment(const TrafficAssignmentResult& result);
+
+    // ==================== TIME-DEPENDENT ROUTING ====================
+    // While the traffic clock runs (AIManager drives it), every road learns its load per time
+    // of day from the loads it carries. A time-dependent search prices each road at the load
+    // predicted for when the route reaches it: the live load at departure, blending into the
+    // learned profile over the first profile bucket.
+    void setTrafficClock(int minuteOfDay) { trafficProfile.setTimeOfDay(minuteOfDay); }
+    void advanceTrafficClock(int minutes) { trafficProfile.advance(minutes); }
+    int getTrafficClock() const { return trafficProfile.getMinuteOfDay(); }
+    void clearTrafficProfiles() { trafficProfile.clear(); }
+    const TrafficProfile& getTrafficProfile() const { return trafficProfile; }
+    // Weight of the road for a vehicle entering it minutesAhead from now (-1 for an invalid ID)
+    double getPredictedEdgeWeight(int edgeID, double minutesAhead) const;
+    // departureMinute is a minute of the day (-1 = now); DIJKSTRA runs without the A* estimate,
+    // every other mode uses it. totalDistance is the predicted weight of the whole route.
+    Vector<int> findShortestPathTimeDependent(int startID, int endID, double& totalDistance,
+        int departureMinute = -1, RouteSearchMode mode = RouteSearchMode::DEFAULT);
+
     // ==================== PATHFINDING ====================
-    Vector<int> findShortestPath(int startID, int endID, double& totalDistance);
-    Vector<int> findShortestPathDynamic(int startID, int endID, double& totalDistance);  // Uses dynamicWeight
+    // mode DEFAULT uses the graph-wide setting (A* unless changed)
+    Vector<int> findShortestPath(int startID, int endID, double& totalDistance,
+        RouteSearchMode mode = RouteSearchMode::DEFAULT);
+    Vector<int> findShortestPathDynamic(int startID, int endID, double& totalDistance,
+        RouteSearchMode mode = RouteSearchMode::DEFAULT);  // Uses dynamicWeight
+    void setDefaultSearchMode(RouteSearchMode mode);
+    RouteSearchMode getDefaultSearchMode() const { return defaultSearchMode; }
+
+    // Optional preprocessing for RouteSearchMode::HIERARCHY (otherwise built on first use)
+    void buildContractionHierarchy();
+    bool hasContractionHierarchy() const { return hierarchy.isBuilt(); }
+    int getHierarchyShortcutCount() const { return hierarchy.getShortcutCount(); }
+    // Optional preprocessing for RouteSearchMode::SECTOR_OVERLAY (otherwise built on first use)
+    void buildSectorOverlay();
+    bool hasSectorOverlay() const { return overlay.isBuilt(); }
+
+    // ==================== ALTERNATIVE ROUTES ====================
+    // Up to maxRoutes routes between two nodes, shortest first (penalty method, see
+    // ALTERNATIVE_ROUTE_PENALTY). Fewer come back where the network offers no route that is
+    // both short and distinct enough; none for invalid or unconnected nodes.
+    Vector<AlternativeRoute> findAlternativeRoutes(int startID, int endID, int maxRoutes = ALTERNATIVE_ROUTE_COUNT,
+        bool dynamic = false, double maxStretch = ALTERNATIVE_ROUTE_MAX_STRETCH,
+        double maxOverlap = ALTERNATIVE_ROUTE_MAX_OVERLAP);
+    // Deals trips between the same two nodes out over their alternatives: consecutive
+    // spreadKeys (e.g. the count of earlier trips between the pair) take different routes,
+    // key 0 the shortest. pickedRoute (optional) receives the index of the route returned,
+    // 0 for the shortest, -1 if there is none.
+    Vector<int> findSpreadRoute(int startID, int endID, int spreadKey, double& totalDistance, bool dynamic = false,
+        int* pickedRoute = nullptr);
+
+    // Route cache sizing and freshness (tolerance = traffic updates a dynamic route may lag)
+    void setRouteCacheCapacity(int capacity) { routeCache.setCapacity(capacity); }
+    void setTrafficStalenessTolerance(int epochs) { routeCache.setStalenessTolerance(epochs); }
+    void clearRouteCache() { routeCache.clear(); }
+    RouteCacheStats getRouteCacheStats() const { return routeCache.getStats(); }
+    void resetRouteCacheStats() { routeCache.resetStats(); }
+
+    // ==================== INCREMENTAL ROUTES ====================
+    // A route held open across ticks on the dynamic metric. Traffic flushes repair only the
+    // routes whose searched area saw a weight change; the owner reports each node it reaches
+    // and asks for the path again when isIncrementalRouteAffected says it may have changed.
+    int openIncrementalRoute(int startID, int goalID);     // Handle, or -1 for invalid nodes
+    void closeIncrementalRoute(int handle) { router.close(handle); }
+    void advanceIncrementalRoute(int handle, int nodeID) { router.moveStart(handle, nodeID); }
+    bool isIncrementalRouteAffected(int handle);
+    Vector<int> getIncrementalRoute(int handle, double& totalDistance);
+    int getIncrementalRouteGoal(int handle) const { return router.getGoal(handle); }
+    const IncrementalRouter& getIncrementalRouter() const { return router; }
+
+    // ==================== SECTOR DISTANCES ====================
+    // Static road distance between the centre intersections of two sectors from a table
+    // covering every sector pair (INF for unknown or unconnected sectors). The table is
+    // recomputed on the first lookup after a road change.
+    double getSectorDistance(int fromSector, int toSector);
+    double getSectorDistance(const string& fromSector, const string& toSector);
+    // The other sectors reachable from fromSector, nearest first (count = 0 for an invalid index);
+    // valid until the next road change
+    const int* getSectorsByDistance(int fromSector, int& count);
+    void buildSectorDistanceTable(int threadCount = 0);    // 0 = every hardware thread
+    bool hasSectorDistanceTable() const { return sectorDistances.isBuilt(); }
+    // A saved table is only loaded if it was computed on an identical road network
+    bool saveSectorDistanceTable(const string& filename) const { return sectorDistances.save(filename); }
+    bool loadSectorDistanceTable(const string& filename);
+    // Hash of every node's roads (targets and static weights); equal graphs give equal values
+    unsigned long long getRoadNetworkSignature() const;
+
+    // ==================== SPATIAL QUERIES ====================
+    // Straight-line (getGridDistance) lookups answered from a bucket grid instead of a node scan
+    int findNearestNode(double lat, double lon, double maxDistanceKm = INF) const;   // -1 if none in range
+    Vector<int> findNodesInRadius(double lat, double lon, double radiusKm) const;
+    const SpatialGrid& getNodeGrid() const { return nodeGrid; }
+
+    // ==================== DISTANCE MATRIX ====================
+    // Network distance from every source to every target in one call, row-major:
+    // result[i * targets.getSize() + j] (INF where unreachable or either ID is invalid).
+    // Replaces one findShortestPath per pair; threadCount 0 uses every hardware thread.
+    Vector<double> distanceMatrix(const Vector<int>& sources, const Vector<int>& targets, int threadCount = 1);
+    Vector<double> distanceMatrixDynamic(const Vector<int>& sources, const Vector<int>& targets,
+        int threadCount = 1);  // Uses dynamicWeight
+
     int findNearestFacility(int fromNodeID, const string& facilityType);
     Vector<int> findAllNearestFacilities(int fromNodeID, const string& facilityType, int maxCount = 5);
     Vector<int> calculateBusRoute(int startNodeID, int endNodeID, double& distance);
@@ -91,31 +335,79 @@ public:
 
 // ==================== CONSTRUCTOR / DESTRUCTOR ====================
 
-inline CityGraph::CityGraph() : nodeCount(0) {
-    for (int i = 0; i < MAX_NODES; i++) {
-        nodes[i] = nullptr;
-    }
-    for (int i = 0; i < 14; i++) {
+inline CityGraph::CityGraph()
+    : nodeCount(0), nameIndex(NODE_LOOKUP_RESERVE), databaseIDIndex(NODE_LOOKUP_RESERVE),
+    stopIDIndex(NODE_LOOKUP_RESERVE), defaultSearchMode(RouteSearchMode::ASTAR), minWeightPerKm(INF),
+    coalesceTraffic(false), trafficUnpublished(false) {
+    for (int i = 0; i < FacilityType::COUNTER_COUNT; i++) {
         facilityCounters[i] = 0;
     }
+    // Refilled every tick; keep the storage between flushes
+    dirtyEdges.setAutoShrink(false);
+    alternativeMasked.setAutoShrink(false);
+    router.attach(&csr, &nodeLat, &nodeLon, &minWeightPerKm);
 }
 
 inline CityGraph::~CityGraph() {
     for (int i = 0; i < nodeCount; i++) {
-        delete nodes[i];
+        nodePool.destroy(nodes[i]);
     }
 }
 
 // ==================== INTERNAL HELPER ====================
 
 inline int CityGraph::createNodeRaw(const string& dbID, const string& sID, const string& name, const string& type, double lat, double lon) {
-    if (nodeCount >= MAX_NODES) return -1;
     int newID = nodeCount;
-    nodes[newID] = new CityNode(newID, dbID, sID, name, type, lat, lon);
+    CityNode* node = nodePool.create(newID, dbID, sID, name, type, lat, lon);
+    nodes.push_back(node);
+    nodeLat.push_back(lat);
+    nodeLon.push_back(lon);
+    nodeSector.push_back(node->sectorID);
+    nodeType.push_back(node->typeID);
+    nodeGrid.insert(newID, lat, lon);
+    if (!nameIndex.contains(name)) nameIndex.insert(name, newID);
+    if (!databaseIDIndex.contains(dbID)) databaseIDIndex.insert(dbID, newID);
+    if (!stopIDIndex.contains(sID)) stopIDIndex.insert(sID, newID);
+    csr.addNode();
+    hierarchy.clear();
+    overlay.clear();
+    router.invalidateAll();
+    facilityIndex.onNodeAdded(newID, node->typeID);
     nodeCount++;
     return newID;
 }
 
+inline int CityGraph::pushRoad(int fromNode, const Edge& edge) {
+    LinkedList<Edge>& roads = nodes[fromNode]->roads;
+    roads.push_back(edge);
+    Edge& added = roads.back();
+    added.id = edgeOrigins.getSize();
+    edgeOrigins.push_back(fromNode);
+    csr.insert(fromNode, &added);
+    if (csr.needsCompaction()) csr.compact();
+    hierarchy.clear();
+    overlay.clear();
+    sectorDistances.clear();
+    router.invalidateAll();
+    facilityIndex.onRoadAdded(csr, fromNode, edge.destinationID, edge.weight);
+    routeCache.bumpTopologyEpoch();
+
+    // Keep the A* heuristic admissible: no road may be cheaper per km than this ratio.
+    // Removing roads can only raise the true minimum, so the bound never needs loosening.
+    int toNode = edge.destinationID;
+    double straight = GeometryUtils::getGridDistance(nodeLat[fromNode], nodeLon[fromNode], nodeLat[toNode], nodeLon[toNode]);
+    if (straight > 1e-9) {
+        double ratio = edge.weight / straight;
+        if (ratio < minWeightPerKm) minWeightPerKm = ratio;
+    }
+    return added.id;
+}
+
+inline void CityGraph::linkReverseEdges(int forwardID, int backwardID) {
+    getEdgeByID(forwardID)->reverseID = backwardID;
+    getEdgeByID(backwardID)->reverseID = forwardID;
+}
+
 // ==================== NODE ACCESS ====================
 
 inline CityNode* CityGraph::getNode(int index) const {
@@ -126,23 +418,9 @@ inline CityNode* CityGraph::getNode(int index) const {
 // ==================== ID GENERATION ====================
 
 inline string CityGraph::generateStopID(const string& type) {
-    string prefix = FacilityType::getStopIDPrefix(type);
-    int counterIdx = 0;
-
-    if (type == FacilityType::MOSQUE) counterIdx = 0;
-    else if (type == FacilityType::PARK) counterIdx = 1;
-    else if (type == FacilityType::WATER_COOLER) counterIdx = 2;
-    else if (type == FacilityType::PLAYGROUND) counterIdx = 3;
-    else if (type == FacilityType::LIBRARY) counterIdx = 4;
-    else if (type == FacilityType::COMMUNITY_CENTER) counterIdx = 5;
-    else if (type == FacilityType::POLICE_STATION) counterIdx = 6;
-    else if (type == FacilityType::FIRE_STATION) counterIdx = 7;
-    else if (type == FacilityType::POST_OFFICE) counterIdx = 8;
-    else if (type == FacilityType::BANK) counterIdx = 9;
-    else if (type == FacilityType::ATM) counterIdx = 10;
-    else if (type == FacilityType::PETROL_STATION) counterIdx = 11;
-    else if (type == FacilityType::RESTAURANT) counterIdx = 12;
-    else if (type == FacilityType::PUBLIC_TOILET) counterIdx = 13;
+    int typeID = FacilityType::lookup(type);
+    string prefix = FacilityType::getStopIDPrefix(typeID);
+    int counterIdx = (typeID >= 0 && typeID < FacilityType::BUILTIN_COUNT) ? FacilityType::COUNTER_INDEX[typeID] : 0;
 
     int count = ++facilityCounters[counterIdx];
 
@@ -249,15 +527,12 @@ inline void CityGraph::initializeSectorFrame(const string& sectorName) {
     // =========================================================
     // 4. STITCHING: CONNECT TO NEIGHBOR SECTORS (HIGHWAY CAPACITY)
     // =========================================================
-    Vector<string> neighbors = GeometryUtils::getAdjacentSectors(sectorName);
+    for (int i = 0; i < SECTOR_TOPOLOGY.adjacentCount[idx]; i++) {
+        int nIdx = SECTOR_TOPOLOGY.adjacent[idx][i];
 
-    for (int i = 0; i < neighbors.getSize(); i++) {
-        string neighborName = neighbors[i];
-        int nIdx = GeometryUtils::getSectorIndex(neighborName);
-
-        // We can only connect if the neighbor exists AND is already initialized.
+        // We can only connect if the neighbor is already initialized.
         // If it's not initialized yet, IT will connect to US when it gets initialized later.
-        if (nIdx == -1 || !SECTOR_GRID[nIdx].initialized) continue;
+        if (!SECTOR_GRID[nIdx].initialized) continue;
 
         SectorBox& otherBox = SECTOR_GRID[nIdx];
 
@@ -308,24 +583,18 @@ inline int CityGraph::addLocation(const string& databaseID, const string& stopID
     const string& name, const string& type,
     double lat, double lon) {
 
-    if (nodeCount >= MAX_NODES) return -1;
-
-    string sector = GeometryUtils::resolveSector(lat, lon);
+    int sectorIdx = GeometryUtils::resolveSectorIndex(lat, lon);
 
     // 1. Initialize Sector if needed
-    if (sector != "Unknown") {
-        int sectorIdx = GeometryUtils::getSectorIndex(sector);
-        if (sectorIdx != -1 && !SECTOR_GRID[sectorIdx].initialized) {
-            initializeSectorFrame(sector);
-        }
+    if (sectorIdx != -1 && !SECTOR_GRID[sectorIdx].initialized) {
+        initializeSectorFrame(SECTOR_GRID[sectorIdx].name);
     }
 
     // 2. For non-corner nodes, snap position to a logical place in the cell
     double finalLat = lat;
     double finalLon = lon;
     
-    if (type != FacilityType::CORNER && sector != "Unknown") {
-        int sectorIdx = GeometryUtils::getSectorIndex(sector);
+    if (type != FacilityType::CORNER) {
         if (sectorIdx != -1) {
             SectorBox& box = SECTOR_GRID[sectorIdx];
             int cellIdx = GeometryUtils::getSubSectorIndex(lat, lon, box);
@@ -363,8 +632,7 @@ inline int CityGraph::addLocation(const string& databaseID, const string& stopID
     if (newID == -1) return -1;
 
     // 4. Logic for Non-Corner Nodes (Connectivity)
-    if (type != FacilityType::CORNER && sector != "Unknown") {
-        int sectorIdx = GeometryUtils::getSectorIndex(sector);
+    if (type != FacilityType::CORNER) {
         if (sectorIdx != -1) {
             SectorBox& box = SECTOR_GRID[sectorIdx];
             int cellIdx = GeometryUtils::getSubSectorIndex(finalLat, finalLon, box);
@@ -433,7 +701,7 @@ inline int CityGraph::addLocation(const string& databaseID, const string& stopID
                         int cID = targetCell->cornerIDs[i];
                         if (cID != -1 && nodes[cID]) {
                             double d = GeometryUtils::getGridDistance(finalLat, finalLon, 
-                                nodes[cID]->lat, nodes[cID]->lon);
+                                nodeLat[cID], nodeLon[cID]);
                             if (d < minCornerDist) {
                                 minCornerDist = d;
                                 closestCornerIdx = i;
@@ -452,19 +720,10 @@ inline int CityGraph::addLocation(const string& databaseID, const string& stopID
                         int existID = existingNodes[i];
                         if (existID == -1 || !nodes[existID]) continue;
                         
-                        const LinkedList<Edge> &roads = nodes[existID]->roads;
-                        bool hasRoadToCorner = false;
-                        for (int r = 0; r < roads.size(); r++) {
-                            if (roads[r].destinationID == closestCornerID) {
-                                hasRoadToCorner = true;
-                                break;
-                            }
-                        }
-                        
-                        if (hasRoadToCorner) {
+                        if (hasRoad(existID, closestCornerID)) {
                             double d = GeometryUtils::getGridDistance(
-                                nodes[existID]->lat, nodes[existID]->lon,
-                                nodes[closestCornerID]->lat, nodes[closestCornerID]->lon);
+                                nodeLat[existID], nodeLon[existID],
+                                nodeLat[closestCornerID], nodeLon[closestCornerID]);
                             if (d < ownerDistToCorner) {
                                 ownerDistToCorner = d;
                                 nodeOwningCorner = existID;
@@ -498,7 +757,7 @@ inline int CityGraph::addLocation(const string& databaseID, const string& stopID
                         if (existID != -1 && nodes[existID]) {
                             sortedNodes[sortCount] = existID;
                             dists[sortCount] = GeometryUtils::getGridDistance(
-                                finalLat, finalLon, nodes[existID]->lat, nodes[existID]->lon);
+                                finalLat, finalLon, nodeLat[existID], nodeLon[existID]);
                             sortCount++;
                         }
                     }
@@ -607,13 +866,13 @@ inline void CityGraph::addFacilityRoad(int id1, int id2) {
     if (hasRoad(id1, id2)) return;
 
     double dist = GeometryUtils::getGridDistance(
-        nodes[id1]->lat, nodes[id1]->lon,
-        nodes[id2]->lat, nodes[id2]->lon
+        nodeLat[id1], nodeLon[id1],
+        nodeLat[id2], nodeLon[id2]
     );
 
     // Apply penalty based on whether this is facility-to-corner or facility-to-facility
-    bool id1IsCorner = (nodes[id1]->type == FacilityType::CORNER);
-    bool id2IsCorner = (nodes[id2]->type == FacilityType::CORNER);
+    bool id1IsCorner = (nodeType[id1] == FacilityType::ID_CORNER);
+    bool id2IsCorner = (nodeType[id2] == FacilityType::ID_CORNER);
     
     double penalty;
     if (id1IsCorner || id2IsCorner) {
@@ -631,8 +890,7 @@ inline void CityGraph::addFacilityRoad(int id1, int id2) {
     Edge edge2(id1, weightedDist, FACILITY_ROAD_CAPACITY);
     edge2.dynamicWeight = weightedDist;
 
-    nodes[id1]->roads.push_back(edge1);
-    nodes[id2]->roads.push_back(edge2);
+    linkReverseEdges(pushRoad(id1, edge1), pushRoad(id2, edge2));
 }
 
 // ==================== PUBLIC FACILITY ====================
@@ -774,32 +1032,50 @@ inline void CityGraph::addRoad(int id1, int id2, int capacity) {
     if (hasRoad(id1, id2)) return;
 
     double dist = GeometryUtils::getGridDistance(
-        nodes[id1]->lat, nodes[id1]->lon,
-        nodes[id2]->lat, nodes[id2]->lon
+        nodeLat[id1], nodeLon[id1],
+        nodeLat[id2], nodeLon[id2]
     );
 
-    nodes[id1]->roads.push_back(Edge(id2, dist, capacity));
-    nodes[id2]->roads.push_back(Edge(id1, dist, capacity));
+    int forward = pushRoad(id1, Edge(id2, dist, capacity));
+    int backward = pushRoad(id2, Edge(id1, dist, capacity));
+    linkReverseEdges(forward, backward);
 }
 
 inline void CityGraph::removeRoad(int id1, int id2) {
     if (id1 < 0 || id2 < 0 || id1 >= nodeCount || id2 >= nodeCount) return;
     if (!nodes[id1] || !nodes[id2]) return;
 
+    bool existed = hasRoad(id1, id2);
+
+    // Drop the CSR slots first: they point into the list nodes erased below.
+    // Pending traffic entries for the road stop resolving along with its edge IDs.
+    csr.remove(id1, id2);
+    csr.remove(id2, id1);
+    hierarchy.clear();
+    overlay.clear();
+    sectorDistances.clear();
+    router.invalidateAll();
+    if (existed) {
+        facilityIndex.onRoadRemoved(csr, id1, id2);
+        routeCache.bumpTopologyEpoch();
+    }
+
     // Remove id2 from id1's roads
     LinkedList<Edge>& roads1 = nodes[id1]->roads;
-    for (int i = 0; i < roads1.size(); i++) {
-        if (roads1[i].destinationID == id2) {
-            roads1.erase(i);
+    int index = 0;
+    for (auto* curr = roads1.getHead(); curr; curr = curr->next, index++) {
+        if (curr->data.destinationID == id2) {
+            roads1.erase(index);
             break;
         }
     }
 
     // Remove id1 from id2's roads
     LinkedList<Edge>& roads2 = nodes[id2]->roads;
-    for (int i = 0; i < roads2.size(); i++) {
-        if (roads2[i].destinationID == id1) {
-            roads2.erase(i);
+    index = 0;
+    for (auto* curr = roads2.getHead(); curr; curr = curr->next, index++) {
+        if (curr->data.destinationID == id1) {
+            roads2.erase(index);
             break;
         }
     }
@@ -807,54 +1083,78 @@ inline void CityGraph::removeRoad(int id1, int id2) {
 
 inline bool CityGraph::hasRoad(int id1, int id2) const {
     if (id1 < 0 || id2 < 0 || id1 >= nodeCount || id2 >= nodeCount) return false;
-    if (!nodes[id1]) return false;
-
-    const LinkedList<Edge>& roads = nodes[id1]->roads;
-    for (int i = 0; i < roads.size(); i++) {
-        if (roads[i].destinationID == id2) {
-            return true;
-        }
-    }
-    return false;
+    return csr.find(id1, id2) != -1;
 }
 
 inline Edge* CityGraph::getEdge(int fromNode, int toNode) {
-    if (fromNode < 0 || fromNode >= nodeCount || !nodes[fromNode]) return nullptr;
-    
-    LinkedList<Edge>& roads = nodes[fromNode]->roads;
-    for (int i = 0; i < roads.size(); i++) {
-        if (roads[i].destinationID == toNode) {
-            return &roads[i];
-        }
-    }
-    return nullptr;
+    if (fromNode < 0 || fromNode >= nodeCount) return nullptr;
+    int slot = csr.find(fromNode, toNode);
+    return (slot != -1) ? csr.edges[slot] : nullptr;
 }
 
 inline const Edge* CityGraph::getEdge(int fromNode, int toNode) const {
-    if (fromNode < 0 || fromNode >= nodeCount || !nodes[fromNode]) return nullptr;
-    
-    const LinkedList<Edge>& roads = nodes[fromNode]->roads;
-    for (int i = 0; i < roads.size(); i++) {
-        if (roads[i].destinationID == toNode) {
-            return &roads[i];
-        }
+    if (fromNode < 0 || fromNode >= nodeCount) return nullptr;
+    int slot = csr.find(fromNode, toNode);
+    return (slot != -1) ? csr.edges[slot] : nullptr;
+}
+
+// ==================== EDGE HANDLES ====================
+
+inline int CityGraph::getEdgeID(int fromNode, int toNode) const {
+    const Edge* edge = getEdge(fromNode, toNode);
+    return edge ? edge->id : -1;
+}
+
+inline Edge* CityGraph::getEdgeByID(int edgeID) {
+    int slot = csr.slotOf(edgeID);
+    return (slot != -1) ? csr.edges[slot] : nullptr;
+}
+
+inline const Edge* CityGraph::getEdgeByID(int edgeID) const {
+    int slot = csr.slotOf(edgeID);
+    return (slot != -1) ? csr.edges[slot] : nullptr;
+}
+
+inline int CityGraph::getReverseEdgeID(int edgeID) const {
+    const Edge* edge = getEdgeByID(edgeID);
+    return edge ? edge->reverseID : -1;
+}
+
+inline int CityGraph::getEdgeOrigin(int edgeID) const {
+    if (edgeID < 0 || edgeID >= edgeOrigins.getSize()) return -1;
+    return edgeOrigins[edgeID];
+}
+
+inline bool CityGraph::isEdgeBetween(int edgeID, int fromNode, int toNode) const {
+    const Edge* edge = getEdgeByID(edgeID);
+    return edge && edge->destinationID == toNode && edgeOrigins[edgeID] == fromNode;
+}
+
+inline Vector<int> CityGraph::getPathEdgeIDs(const Vector<int>& path) const {
+    Vector<int> ids;
+    for (int i = 0; i + 1 < path.getSize(); i++) {
+        ids.push_back(getEdgeID(path[i], path[i + 1]));
     }
-    return nullptr;
+    return ids;
 }
 
 // ==================== TRAFFIC MANAGEMENT ====================
+// Loads are updated through edge IDs: one array lookup per direction. The node-pair
+// overloads only resolve the ID first.
 
-inline bool CityGraph::tryEnterEdge(int fromNode, int toNode) {
-    Edge* edge = getEdge(fromNode, toNode);
+inline bool CityGraph::tryEnterEdge(int edgeID) {
+    Edge* edge = getEdgeByID(edgeID);
     if (!edge) return false;
     
     if (edge->currentLoad < edge->capacity) {
         edge->currentLoad++;
+        markTrafficDirty(edge);
         
         // Also update the reverse edge (bidirectional roads share load)
-        Edge* reverseEdge = getEdge(toNode, fromNode);
+        Edge* reverseEdge = getEdgeByID(edge->reverseID);
         if (reverseEdge) {
             reverseEdge->currentLoad++;
+            markTrafficDirty(reverseEdge);
         }
         
         return true;
@@ -863,271 +1163,1008 @@ inline bool CityGraph::tryEnterEdge(int fromNode, int toNode) {
     return false;  // Road is at capacity, vehicle must wait
 }
 
-inline void CityGraph::leaveEdge(int fromNode, int toNode) {
-    Edge* edge = getEdge(fromNode, toNode);
-    if (edge && edge->currentLoad > 0) {
+inline bool CityGraph::tryEnterEdge(int fromNode, int toNode) {
+    return tryEnterEdge(getEdgeID(fromNode, toNode));
+}
+
+inline void CityGraph::leaveEdge(int edgeID) {
+    Edge* edge = getEdgeByID(edgeID);
+    if (!edge) return;
+
+    if (edge->currentLoad > 0) {
         edge->currentLoad--;
+        markTrafficDirty(edge);
     }
     
     // Also update the reverse edge
-    Edge* reverseEdge = getEdge(toNode, fromNode);
+    Edge* reverseEdge = getEdgeByID(edge->reverseID);
     if (reverseEdge && reverseEdge->currentLoad > 0) {
         reverseEdge->currentLoad--;
+        markTrafficDirty(reverseEdge);
     }
 }
 
+inline void CityGraph::leaveEdge(int fromNode, int toNode) {
+    leaveEdge(getEdgeID(fromNode, toNode));
+}
+
 inline void CityGraph::updateTrafficWeights() {
-    for (int i = 0; i < nodeCount; i++) {
-        if (!nodes[i]) continue;
-        
-        LinkedList<Edge>& roads = nodes[i]->roads;
-        for (int j = 0; j < roads.size(); j++) {
-            roads[j].updateDynamicWeight();
-        }
+    if (!coalesceTraffic) flushTrafficUpdates();
+}
+
+inline void CityGraph::setTrafficCoalescing(bool enabled) {
+    coalesceTraffic = enabled;
+    if (!enabled) flushTrafficUpdates();
+}
+
+// Every load change passes through here, so the profile hears about each one even while
+// the edge is already waiting for a flush
+inline void CityGraph::markTrafficDirty(Edge* edge) {
+    trafficProfile.observe(edge->id, edge->currentLoad);
+    if (edge->trafficDirty) return;
+    edge->trafficDirty = true;
+    dirtyEdges.push_back(edge->id);
+}
+
+// Recomputes only the edges touched by tryEnterEdge/leaveEdge since the last call and
+// tells incremental routes about each road whose weight did change. The overlay and the
+// route cache are left alone: flushTrafficUpdates publishes the change to them.
+// IDs of roads removed in the meantime no longer resolve and are skipped.
+inline void CityGraph::applyTrafficWeights() {
+    double* dynamicWeights = csr.dynamicWeights.begin();
+    for (int i = 0; i < dirtyEdges.getSize(); i++) {
+        int slot = csr.slotOf(dirtyEdges[i]);
+        if (slot == -1) continue;
+
+        Edge* edge = csr.edges[slot];
+        edge->trafficDirty = false;
+        edge->updateDynamicWeight();
+        if (dynamicWeights[slot] == edge->dynamicWeight) continue;   // Load went up and back down
+
+        dynamicWeights[slot] = edge->dynamicWeight;
+        router.onEdgeChanged(edgeOrigins[dirtyEdges[i]], edge->destinationID);
+        trafficUnpublished = true;
     }
+    dirtyEdges.clear();
 }
 
-inline double CityGraph::getEdgeCongestion(int fromNode, int toNode) const {
-    const Edge* edge = getEdge(fromNode, toNode);
+// Nothing is invalidated when no weight changed, so idle ticks keep dynamic routes cached
+inline void CityGraph::flushTrafficUpdates() {
+    applyTrafficWeights();
+    if (!trafficUnpublished) return;
+
+    overlay.invalidateTraffic();
+    routeCache.bumpTrafficEpoch();
+    trafficUnpublished = false;
+}
+
+inline double CityGraph::getEdgeCongestion(int edgeID) const {
+    const Edge* edge = getEdgeByID(edgeID);
     if (!edge) return 0.0;
     return edge->getCongestionFactor();
 }
 
+inline double CityGraph::getEdgeCongestion(int fromNode, int toNode) const {
+    return getEdgeCongestion(getEdgeID(fromNode, toNode));
+}
+
 inline int CityGraph::getTotalVehiclesOnRoads() const {
     int total = 0;
-    for (int i = 0; i < nodeCount; i++) {
-        if (!nodes[i]) continue;
-        
-        const LinkedList<Edge>& roads = nodes[i]->roads;
-        for (int j = 0; j < roads.size(); j++) {
-            total += roads[j].currentLoad;
+    Edge* const* edges = csr.edges.begin();
+    for (int u = 0; u < nodeCount; u++) {
+        int begin = csr.rowStart[u];
+        int end = begin + csr.rowDegree[u];
+        for (int k = begin; k < end; k++) {
+            total += edges[k]->currentLoad;
         }
     }
     // Divide by 2 because roads are bidirectional and we count each edge twice
     return total / 2;
 }
 
-// ==================== PATHFINDING WITH DYNAMIC WEIGHTS ====================
+// ==================== TRAFFIC ASSIGNMENT ====================
+// Flows are kept per CSR slot (one direction of a road); the cost of a slot depends on the
+// load of its road, i.e. its own flow plus the flow of its reverse slot, the same sharing
+// tryEnterEdge applies to live traffic.
+
+inline TrafficAssignmentResult CityGraph::assignTraffic(const Vector<TripDemand>& demand, int threadCount,
+    int maxIterations, double gapTolerance) {
+    auto start = std::chrono::steady_clock::now();
+    TrafficAssignmentResult result;
+
+    // 1. Group the trip table by origin (counting sort on the origin ID)
+    OriginTrips trips;
+    Vector<int> perOrigin;
+    perOrigin.resize(nodeCount + 1, 0);
+    for (int i = 0; i < demand.getSize(); i++) {
+        const TripDemand& d = demand[i];
+        if (!(d.trips > 0.0) || d.originID == d.destinationID) continue;
+        if (d.originID < 0 || d.originID >= nodeCount || d.destinationID < 0 || d.destinationID >= nodeCount) {
+            result.unroutedTrips += d.trips;
+            continue;
+        }
+        perOrigin[d.originID + 1]++;
+    }
+    for (int u = 0; u < nodeCount; u++) {
+        if (perOrigin[u + 1] > 0) trips.origins.push_back(u);
+        perOrigin[u + 1] += perOrigin[u];
+    }
+    trips.tripDestination.resize(perOrigin[nodeCount], -1);
+    trips.tripVolume.resize(perOrigin[nodeCount], 0.0);
+    for (int i = 0; i < trips.origins.getSize(); i++) {
+        trips.tripStart.push_back(perOrigin[trips.origins[i]]);
+    }
+    trips.tripStart.push_back(perOrigin[nodeCount]);
+    for (int i = 0; i < demand.getSize(); i++) {
+        const TripDemand& d = demand[i];
+        if (!(d.trips > 0.0) || d.originID == d.destinationID) continue;
+        if (d.originID < 0 || d.originID >= nodeCount || d.destinationID < 0 || d.destinationID >= nodeCount) continue;
+        int k = perOrigin[d.originID]++;
+        trips.tripDestination[k] = d.destinationID;
+        trips.tripVolume[k] = d.trips;
+    }
+
+    // 2. Per-slot road data (slots outside every row never carry flow)
+    int slotCount = csr.getSlotCount();
+    const double* lengths = csr.weights.begin();
+    Vector<int> liveSlots;
+    Vector<int> reverseSlot;
+    Vector<int> slotCapacity;
+    reverseSlot.resize(slotCount, -1);
+    slotCapacity.resize(slotCount, 0);
+    for (int u = 0; u < nodeCount; u++) {
+        int end = csr.rowStart[u] + csr.rowDegree[u];
+        for (int k = csr.rowStart[u]; k < end; k++) {
+            liveSlots.push_back(k);
+            reverseSlot[k] = csr.slotOf(csr.edges[k]->reverseID);
+            slotCapacity[k] = csr.edges[k]->capacity;
+        }
+    }
 
-inline Vector<int> CityGraph::findShortestPathDynamic(int startID, int endID, double& totalDistance) {
-    Vector<int> path;
-    totalDistance = 0.0;
+    auto roadLoad = [&](const Vector<double>& flow, int k) {
+        return flow[k] + ((reverseSlot[k] != -1) ? flow[reverseSlot[k]] : 0.0);
+    };
+    Vector<double> costs;
+    costs.resize(slotCount, 0.0);
+    auto updateCosts = [&](const Vector<double>& flow) {
+        for (int i = 0; i < liveSlots.getSize(); i++) {
+            int k = liveSlots[i];
+            costs[k] = Edge::getCongestedWeight(lengths[k], roadLoad(flow, k), slotCapacity[k]);
+        }
+    };
+
+    // 3. Frank-Wolfe: start from free-flow shortest paths, then repeatedly move part of the
+    //    flow towards the shortest paths under the current congestion
+    double unrouted = 0.0;
+    Vector<double> flow = assignAllOrNothing(trips, lengths, threadCount, unrouted);
+    result.unroutedTrips += unrouted;
+    for (int i = 0; i < trips.tripVolume.getSize(); i++) {
+        result.assignedTrips += trips.tripVolume[i];
+    }
+    result.assignedTrips -= unrouted;
+
+    for (int iteration = 1; iteration <= maxIterations; iteration++) {
+        updateCosts(flow);
+        double ignored = 0.0;
+        Vector<double> target = assignAllOrNothing(trips, costs.begin(), threadCount, ignored);
+
+        // Relative gap: how much cheaper everyone's current shortest path is than their route
+        double current = 0.0;
+        double shortest = 0.0;
+        for (int i = 0; i < liveSlots.getSize(); i++) {
+            int k = liveSlots[i];
+            current += flow[k] * costs[k];
+            shortest += target[k] * costs[k];
+        }
+        result.iterations = iteration;
+        result.relativeGap = (current > 0.0) ? (current - shortest) / current : 0.0;
+        if (result.relativeGap <= gapTolerance) break;
+
+        // Step size minimizing the Beckmann objective along flow -> target (bisection on its
+        // derivative, which is increasing in the step)
+        auto slope = [&](double step) {
+            double sum = 0.0;
+            for (int i = 0; i < liveSlots.getSize(); i++) {
+                int k = liveSlots[i];
+                double direction = target[k] - flow[k];
+                if (direction == 0.0) continue;
+                double loadNow = roadLoad(flow, k);
+                double load = loadNow + step * (roadLoad(target, k) - loadNow);
+                sum += Edge::getCongestedWeight(lengths[k], load, slotCapacity[k]) * direction;
+            }
+            return sum;
+        };
+        double step = 1.0;
+        if (slope(1.0) > 0.0) {
+            double low = 0.0;
+            double high = 1.0;
+            for (int b = 0; b < 40; b++) {
+                double mid = 0.5 * (low + high);
+                if (slope(mid) > 0.0) high = mid;
+                else low = mid;
+            }
+            step = 0.5 * (low + high);
+        }
+
+        for (int i = 0; i < liveSlots.getSize(); i++) {
+            int k = liveSlots[i];
+            flow[k] += step * (target[k] - flow[k]);
+        }
+    }
+
+    // 4. Report per edge ID
+    updateCosts(flow);
+    result.edgeLoad.resize(edgeOrigins.getSize(), 0.0);
+    result.edgeWeight.resize(edgeOrigins.getSize(), 0.0);
+    for (int i = 0; i < liveSlots.getSize(); i++) {
+        int k = liveSlots[i];
+        int id = csr.edges[k]->id;
+        result.edgeLoad[id] = roadLoad(flow, k);
+        result.edgeWeight[id] = costs[k];
+        result.totalTravelCost += flow[k] * costs[k];
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    result.elapsedMs = std::chrono::duration<double, std::milli>(end - start).count();
+    return result;
+}
 
+// Origins are split across the threads; each thread adds its trips into its own flow array
+// and the arrays are summed afterwards
+inline Vector<double> CityGraph::assignAllOrNothing(const OriginTrips& trips, const double* costs, int threadCount,
+    double& unrouted) const {
+    int slotCount = csr.getSlotCount();
+    int originCount = trips.origins.getSize();
+    if (threadCount <= 0) threadCount = (int)std::thread::hardware_concurrency();
+    if (threadCount > originCount) threadCount = originCount;
+    if (threadCount < 1) threadCount = 1;
+
+    Vector<Vector<double>> partialFlow;
+    Vector<double> partialUnrouted;
+    partialFlow.resize(threadCount);
+    partialUnrouted.resize(threadCount, 0.0);
+
+    runParallel(threadCount, threadCount, [&](int t) {
+        Vector<double>& flow = partialFlow[t];
+        flow.resize(slotCount, 0.0);
+        Vector<unsigned char> isTarget;
+        isTarget.resize(nodeCount, 0);
+        SearchWorkspace& ws = getWorkspace();
+
+        for (int i = t; i < originCount; i += threadCount) {
+            int origin = trips.origins[i];
+            int first = trips.tripStart[i];
+            int last = trips.tripStart[i + 1];
+
+            int distinct = 0;
+            for (int k = first; k < last; k++) {
+                int destination = trips.tripDestination[k];
+                if (!isTarget[destination]) distinct++;
+                isTarget[destination] = 1;
+            }
+            searchToTargets(origin, isTarget, distinct, costs, ws);
+
+            for (int k = first; k < last; k++) {
+                int destination = trips.tripDestination[k];
+                isTarget[destination] = 0;
+                if (!ws.isSettled(destination)) {
+                    partialUnrouted[t] += trips.tripVolume[k];
+                    continue;
+                }
+                for (int v = destination; v != origin; v = ws.parent[v]) {
+                    flow[ws.parentArc[v]] += trips.tripVolume[k];
+                }
+            }
+        }
+    });
+
+    Vector<double> total;
+    total.resize(slotCount, 0.0);
+    unrouted = 0.0;
+    for (int t = 0; t < threadCount; t++) {
+        const Vector<double>& flow = partialFlow[t];
+        for (int k = 0; k < flow.getSize(); k++) {
+            total[k] += flow[k];
+        }
+        unrouted += partialUnrouted[t];
+    }
+    return total;
+}
+
+inline void CityGraph::applyTrafficAssignment(const TrafficAssignmentResult& result) {
+    for (int id = 0; id < result.edgeLoad.getSize(); id++) {
+        Edge* edge = getEdgeByID(id);
+        if (!edge) continue;
+
+        int load = (int)std::lround(result.edgeLoad[id]);
+        if (load > edge->capacity) load = edge->capacity;
+        if (load < 0) load = 0;
+        if (edge->currentLoad == load) continue;
+        edge->currentLoad = load;
+        markTrafficDirty(edge);
+    }
+    updateTrafficWeights();
+}
+
+// ==================== TIME-DEPENDENT ROUTING ====================
+
+inline double CityGraph::predictWeight(const Edge* edge, double minutesAhead) const {
+    double live = (double)edge->currentLoad;
+    double load = live;
+    double predicted;
+    double minuteOfDay = trafficProfile.getMinuteOfDay() + minutesAhead;
+    if (trafficProfile.predictLoad(edge->id, minuteOfDay, predicted)) {
+        double share = minutesAhead / TRAFFIC_PROFILE_BUCKET_MINUTES;
+        if (share > 1.0) share = 1.0;
+        load = live + share * (predicted - live);
+    }
+    return Edge::getCongestedWeight(edge->weight, load, edge->capacity);
+}
+
+inline double CityGraph::getPredictedEdgeWeight(int edgeID, double minutesAhead) const {
+    const Edge* edge = getEdgeByID(edgeID);
+    if (!edge) return -1.0;
+    return predictWeight(edge, (minutesAhead > 0.0) ? minutesAhead : 0.0);
+}
+
+// Dijkstra / A* on arrival-time-dependent weights: a road's weight is predicted for the
+// time the route reaches its start, with weight / TRAFFIC_PROFILE_KM_PER_MINUTE minutes per
+// road travelled. Congestion only adds weight, so the static A* estimate stays a lower bound.
+// Predictions move smoothly between bucket centres, which keeps later departures from
+// arriving earlier in practice - the FIFO property this label-setting search needs to be exact.
+// Results depend on the clock and are not cached.
+inline Vector<int> CityGraph::findShortestPathTimeDependent(int startID, int endID, double& totalDistance,
+    int departureMinute, RouteSearchMode mode) {
+    totalDistance = 0.0;
     if (startID < 0 || startID >= nodeCount || endID < 0 || endID >= nodeCount) {
-        return path;
+        return Vector<int>();
     }
 
-    double distance[MAX_NODES];
-    int parent[MAX_NODES];
-    bool visited[MAX_NODES];
+    if (mode == RouteSearchMode::DEFAULT) mode = defaultSearchMode;
+    bool useHeuristic = (mode != RouteSearchMode::DIJKSTRA);
 
-    for (int i = 0; i < MAX_NODES; i++) {
-        distance[i] = INF;
-        parent[i] = -1;
-        visited[i] = false;
+    double departure = 0.0;
+    if (departureMinute >= 0) {
+        departure = (double)((departureMinute - trafficProfile.getMinuteOfDay() + MINUTES_PER_DAY) % MINUTES_PER_DAY);
     }
 
-    PriorityQueue<DijkstraNode> pq;
-    distance[startID] = 0.0;
-    pq.push(DijkstraNode(startID, 0.0));
+    SearchWorkspace& ws = getWorkspace();
+    ws.begin(nodeCount);
 
-    while (!pq.empty()) {
-        DijkstraNode current = pq.top();
-        pq.pop();
+    const int* targets = csr.targets.begin();
+    Edge* const* edges = csr.edges.begin();
 
-        int u = current.nodeID;
-        if (visited[u]) continue;
-        visited[u] = true;
+    ws.setDistance(startID, 0.0, -1);
+    ws.heap.push(DijkstraNode(startID, useHeuristic ? estimateDistance(startID, endID) : 0.0));
 
-        if (u == endID) break;
+    while (!ws.heap.empty()) {
+        DijkstraNode current = ws.heap.top();
+        ws.heap.pop();
 
-        if (!nodes[u]) continue;
+        int u = current.nodeID;
+        if (ws.isSettled(u)) continue;
+        ws.settle(u);
 
-        const LinkedList<Edge>& roads = nodes[u]->roads;
-        for (int i = 0; i < roads.size(); i++) {
-            int v = roads[i].destinationID;
-            // Use dynamicWeight instead of weight for traffic-aware routing
-            double weight = roads[i].dynamicWeight;
+        if (u == endID) break;
 
-            if (!visited[v] && distance[u] + weight < distance[v]) {
-                distance[v] = distance[u] + weight;
-                parent[v] = u;
-                pq.push(DijkstraNode(v, distance[v]));
+        double distU = ws.distance[u];
+        double arrival = departure + distU / TRAFFIC_PROFILE_KM_PER_MINUTE;
+        int end = csr.rowStart[u] + csr.rowDegree[u];
+        for (int k = csr.rowStart[u]; k < end; k++) {
+            int v = targets[k];
+            if (ws.isSettled(v)) continue;
+
+            double candidate = distU + predictWeight(edges[k], arrival);
+            if (candidate < ws.getDistance(v)) {
+                ws.setDistance(v, candidate, u);
+                double key = useHeuristic ? candidate + estimateDistance(v, endID) : candidate;
+                ws.heap.push(DijkstraNode(v, key));
             }
         }
     }
 
-    if (parent[endID] != -1 || startID == endID) {
-        int current = endID;
-        while (current != -1) {
-            path.push_back(current);
-            current = parent[current];
+    Vector<int> path = ws.tracePath(endID);
+    if (path.getSize() > 0) totalDistance = ws.distance[endID];
+    return path;
+}
+
+// ==================== PATHFINDING ====================
+// Both entry points share one set of searches; they only differ in which CSR weight
+// array is read (Edge::weight or the traffic-aware Edge::dynamicWeight).
+
+inline Vector<int> CityGraph::findShortestPath(int startID, int endID, double& totalDistance, RouteSearchMode mode) {
+    return searchPath(startID, endID, totalDistance, csr.weights.begin(), mode);
+}
+
+inline Vector<int> CityGraph::findShortestPathDynamic(int startID, int endID, double& totalDistance, RouteSearchMode mode) {
+    return searchPath(startID, endID, totalDistance, csr.dynamicWeights.begin(), mode);
+}
+
+// ==================== ALTERNATIVE ROUTES ====================
+// Overlap is measured per CSR slot (one direction of a road), so driving a road the other way
+// does not count as sharing it.
+
+inline Vector<AlternativeRoute> CityGraph::findAlternativeRoutes(int startID, int endID, int maxRoutes,
+    bool dynamic, double maxStretch, double maxOverlap) {
+    Vector<AlternativeRoute> routes;
+    if (maxRoutes < 1) return routes;
+    if (maxRoutes > 32) maxRoutes = 32;     // One bit per kept route in routeMask
+
+    const double* weights = dynamic ? csr.dynamicWeights.begin() : csr.weights.begin();
+    AlternativeRoute shortest;
+    shortest.path = searchPath(startID, endID, shortest.distance, weights, RouteSearchMode::DEFAULT);
+    if (shortest.path.getSize() == 0) return routes;
+    routes.push_back(shortest);
+    if (maxRoutes == 1 || startID == endID) return routes;
+
+    // The weights may have changed since the last call, so the penalized copy is refilled;
+    // the mask is all zero between calls (cleared below through alternativeMasked)
+    int slotCount = csr.getSlotCount();
+    if (alternativeMask.getSize() < slotCount) {
+        alternativeWeights.resize(slotCount, 0.0);
+        alternativeMask.resize(slotCount, 0u);
+    }
+    double* penalized = alternativeWeights.begin();
+    unsigned int* routeMask = alternativeMask.begin();
+    for (int k = 0; k < slotCount; k++) penalized[k] = weights[k];
+
+    Vector<int> slots;
+    Vector<int> candidate = shortest.path;
+    int searches = (maxRoutes - 1) * ALTERNATIVE_ROUTE_SEARCHES;
+    for (int attempt = 0; attempt <= searches; attempt++) {
+        slots.clear();
+        double distance = 0.0;
+        for (int i = 0; i + 1 < candidate.getSize(); i++) {
+            int slot = csr.find(candidate[i], candidate[i + 1]);
+            slots.push_back(slot);
+            distance += weights[slot];
         }
 
-        for (int i = 0; i < path.getSize() / 2; i++) {
-            int temp = path[i];
-            path[i] = path[path.getSize() - 1 - i];
-            path[path.getSize() - 1 - i] = temp;
+        // Every route but the shortest must be short and distinct enough to be kept
+        bool kept = (attempt == 0);
+        if (!kept) {
+            if (distance > maxStretch * shortest.distance) break;
+
+            double overlap = 0.0;
+            for (int r = 0; r < routes.getSize(); r++) {
+                double shared = 0.0;
+                for (int i = 0; i < slots.getSize(); i++) {
+                    if (routeMask[slots[i]] & (1u << r)) shared += weights[slots[i]];
+                }
+                double share = (distance > 0.0) ? shared / distance : 1.0;
+                if (share > overlap) overlap = share;
+            }
+
+            if (overlap <= maxOverlap) {
+                AlternativeRoute route;
+                route.path = candidate;
+                route.distance = distance;
+                route.overlap = overlap;
+                routes.push_back(route);
+                if (routes.getSize() == maxRoutes) break;
+                kept = true;
+            }
+        }
+        if (kept) {
+            unsigned int bit = 1u << (routes.getSize() - 1);
+            for (int i = 0; i < slots.getSize(); i++) {
+                if (routeMask[slots[i]] == 0u) alternativeMasked.push_back(slots[i]);
+                routeMask[slots[i]] |= bit;
+            }
         }
 
-        totalDistance = distance[endID];
+        // Rejected candidates are penalized too, or the next search would find them again
+        for (int i = 0; i < slots.getSize(); i++) penalized[slots[i]] *= ALTERNATIVE_ROUTE_PENALTY;
+
+        double penalizedDistance;
+        candidate = searchDijkstra(startID, endID, penalizedDistance, penalized, true);
+        if (candidate.getSize() == 0) break;
     }
 
-    return path;
+    for (int i = 0; i < alternativeMasked.getSize(); i++) routeMask[alternativeMasked[i]] = 0u;
+    alternativeMasked.clear();
+    return routes;
 }
 
-// ==================== PATHFINDING ====================
-
-inline Vector<int> CityGraph::findShortestPath(int startID, int endID, double& totalDistance) {
-    Vector<int> path;
+inline Vector<int> CityGraph::findSpreadRoute(int startID, int endID, int spreadKey, double& totalDistance,
+    bool dynamic, int* pickedRoute) {
     totalDistance = 0.0;
+    if (pickedRoute) *pickedRoute = -1;
+    if (spreadKey < 0) spreadKey = -(spreadKey + 1);
+
+    // Only search as many alternatives as the key can reach
+    int wanted = spreadKey % ALTERNATIVE_ROUTE_COUNT;
+    Vector<AlternativeRoute> routes = findAlternativeRoutes(startID, endID, wanted + 1, dynamic);
+    if (routes.getSize() == 0) return Vector<int>();
+
+    int pick = (wanted < routes.getSize()) ? wanted : spreadKey % routes.getSize();
+    if (pickedRoute) *pickedRoute = pick;
+    totalDistance = routes[pick].distance;
+    return routes[pick].path;
+}
 
-    if (startID < 0 || startID >= nodeCount || endID < 0 || endID >= nodeCount) {
-        return path;
+// ==================== INCREMENTAL ROUTES ====================
+
+inline int CityGraph::openIncrementalRoute(int startID, int goalID) {
+    if (startID < 0 || startID >= nodeCount || goalID < 0 || goalID >= nodeCount) return -1;
+    return router.open(startID, goalID);
+}
+
+// Pending loads are applied first so the answer reflects every tryEnterEdge/leaveEdge so
+// far. Only the weights are refreshed: these run per vehicle per step, and a full flush
+// here would expire cached dynamic routes and the overlay once per vehicle.
+inline bool CityGraph::isIncrementalRouteAffected(int handle) {
+    applyTrafficWeights();
+    return router.isAffected(handle);
+}
+
+inline Vector<int> CityGraph::getIncrementalRoute(int handle, double& totalDistance) {
+    applyTrafficWeights();
+    return router.getPath(handle, totalDistance);
+}
+
+// ==================== SECTOR DISTANCES ====================
+
+inline double CityGraph::getSectorDistance(int fromSector, int toSector) {
+    if (!sectorDistances.isBuilt()) buildSectorDistanceTable();
+    return sectorDistances.get(fromSector, toSector);
+}
+
+inline const int* CityGraph::getSectorsByDistance(int fromSector, int& count) {
+    if (!sectorDistances.isBuilt()) buildSectorDistanceTable();
+    return sectorDistances.getOrder(fromSector, count);
+}
+
+inline double CityGraph::getSectorDistance(const string& fromSector, const string& toSector) {
+    return getSectorDistance(GeometryUtils::getSectorIndex(fromSector), GeometryUtils::getSectorIndex(toSector));
+}
+
+inline void CityGraph::buildSectorDistanceTable(int threadCount) {
+    // Uninitialized sectors get an invalid centre and so stay INF to everything
+    Vector<int> centres;
+    for (int s = 0; s < SECTOR_COUNT; s++) {
+        centres.push_back(SECTOR_GRID[s].initialized ? SECTOR_GRID[s].gridCorners[SECTOR_CENTRE_ROW][SECTOR_CENTRE_COL] : -1);
     }
+    sectorDistances.assign(distanceMatrix(centres, centres, threadCount), getRoadNetworkSignature());
+}
 
-    double distance[MAX_NODES];
-    int parent[MAX_NODES];
-    bool visited[MAX_NODES];
+inline bool CityGraph::loadSectorDistanceTable(const string& filename) {
+    return sectorDistances.load(filename, getRoadNetworkSignature());
+}
 
-    for (int i = 0; i < MAX_NODES; i++) {
-        distance[i] = INF;
-        parent[i] = -1;
-        visited[i] = false;
+// FNV-1a over the node count and every road's end node and weight bits, in list order
+inline unsigned long long CityGraph::getRoadNetworkSignature() const {
+    const unsigned long long prime = 1099511628211ULL;
+    unsigned long long hash = 14695981039346656037ULL;
+    auto mix = [&](unsigned long long value) {
+        for (int b = 0; b < 8; b++) {
+            hash ^= (value >> (b * 8)) & 0xFF;
+            hash *= prime;
+        }
+    };
+
+    mix((unsigned long long)nodeCount);
+    for (int u = 0; u < nodeCount; u++) {
+        mix((unsigned long long)nodes[u]->roads.size());
+        for (auto* e = nodes[u]->roads.getHead(); e; e = e->next) {
+            unsigned long long weightBits = 0;
+            std::memcpy(&weightBits, &e->data.weight, sizeof(double));
+            mix((unsigned long long)e->data.destinationID);
+            mix(weightBits);
+        }
     }
+    return hash;
+}
 
-    PriorityQueue<DijkstraNode> pq;
-    distance[startID] = 0.0;
-    pq.push(DijkstraNode(startID, 0.0));
+// ==================== SPATIAL QUERIES ====================
 
-    while (!pq.empty()) {
-        DijkstraNode current = pq.top();
-        pq.pop();
+inline int CityGraph::findNearestNode(double lat, double lon, double maxDistanceKm) const {
+    return nodeGrid.findNearest(lat, lon, maxDistanceKm);
+}
 
-        int u = current.nodeID;
-        if (visited[u]) continue;
-        visited[u] = true;
+inline Vector<int> CityGraph::findNodesInRadius(double lat, double lon, double radiusKm) const {
+    return nodeGrid.findInRadius(lat, lon, radiusKm);
+}
 
-        if (u == endID) break;
+// ==================== DISTANCE MATRIX ====================
 
-        if (!nodes[u]) continue;
+// Static-weight matrices with at least this many searches go through the contraction
+// hierarchy, building it if needed (a build costs about as much as a few hundred searches)
+constexpr int DISTANCE_MATRIX_HIERARCHY_ROWS = 256;
 
-        const LinkedList<Edge>& roads = nodes[u]->roads;
-        for (int i = 0; i < roads.size(); i++) {
-            int v = roads[i].destinationID;
-            double weight = roads[i].weight;
+inline Vector<double> CityGraph::distanceMatrix(const Vector<int>& sources, const Vector<int>& targets,
+    int threadCount) {
+    return computeDistanceMatrix(sources, targets, csr.weights.begin(), threadCount);
+}
+
+inline Vector<double> CityGraph::distanceMatrixDynamic(const Vector<int>& sources, const Vector<int>& targets,
+    int threadCount) {
+    flushTrafficUpdates();
+    return computeDistanceMatrix(sources, targets, csr.dynamicWeights.begin(), threadCount);
+}
+
+// Both directions of a road always carry the same weight and load, so d(s, t) == d(t, s):
+// the matrix is searched from whichever side is smaller and transposed if needed.
+inline Vector<double> CityGraph::computeDistanceMatrix(const Vector<int>& sources, const Vector<int>& targets,
+    const double* weights, int threadCount) {
+    int sourceCount = sources.getSize();
+    int targetCount = targets.getSize();
+    Vector<double> result;
+    result.resize(sourceCount * targetCount, INF);
+    if (sourceCount == 0 || targetCount == 0) return result;
+
+    bool transposed = (sourceCount > targetCount);
+    const Vector<int>& rows = transposed ? targets : sources;
+    const Vector<int>& columns = transposed ? sources : targets;
+    int rowCount = rows.getSize();
+    int columnCount = columns.getSize();
+
+    Vector<double> table;
+    table.resize(rowCount * columnCount, INF);
+
+    bool useHierarchy = (weights == csr.weights.begin()) &&
+        (hierarchy.isBuilt() || rowCount >= DISTANCE_MATRIX_HIERARCHY_ROWS);
+
+    if (useHierarchy) {
+        if (!hierarchy.isBuilt()) buildContractionHierarchy();
+        ContractionHierarchy::TargetBuckets buckets;
+        hierarchy.collectBuckets(columns, buckets, getWorkspace());
+
+        runParallel(rowCount, threadCount, [&](int i) {
+            hierarchy.scanBuckets(rows[i], buckets, &table[i * columnCount], getWorkspace());
+        });
+    }
+    else {
+        Vector<unsigned char> isColumn;
+        isColumn.resize(nodeCount, 0);
+        int distinctColumns = 0;
+        for (int j = 0; j < columnCount; j++) {
+            int c = columns[j];
+            if (c < 0 || c >= nodeCount || isColumn[c]) continue;
+            isColumn[c] = 1;
+            distinctColumns++;
+        }
 
-            if (!visited[v] && distance[u] + weight < distance[v]) {
-                distance[v] = distance[u] + weight;
-                parent[v] = u;
-                pq.push(DijkstraNode(v, distance[v]));
+        runParallel(rowCount, threadCount, [&](int i) {
+            int r = rows[i];
+            if (r < 0 || r >= nodeCount || distinctColumns == 0) return;
+            SearchWorkspace& ws = getWorkspace();
+            searchToTargets(r, isColumn, distinctColumns, weights, ws);
+            for (int j = 0; j < columnCount; j++) {
+                int c = columns[j];
+                if (c >= 0 && c < nodeCount) table[i * columnCount + j] = ws.getDistance(c);
             }
+        });
+    }
+
+    for (int i = 0; i < rowCount; i++) {
+        for (int j = 0; j < columnCount; j++) {
+            int index = transposed ? (j * targetCount + i) : (i * targetCount + j);
+            result[index] = table[i * columnCount + j];
         }
     }
+    return result;
+}
 
-    if (parent[endID] != -1 || startID == endID) {
-        int current = endID;
-        while (current != -1) {
-            path.push_back(current);
-            current = parent[current];
+inline void CityGraph::searchToTargets(int sourceID, const Vector<unsigned char>& isTarget, int targetCount,
+    const double* weights, SearchWorkspace& ws) const {
+    ws.begin(nodeCount);
+    ws.setDistance(sourceID, 0.0, -1);
+    ws.heap.push(DijkstraNode(sourceID, 0.0));
+
+    const int* targets = csr.targets.begin();
+    int remaining = targetCount;
+
+    while (!ws.heap.empty()) {
+        DijkstraNode current = ws.heap.top();
+        ws.heap.pop();
+
+        int u = current.nodeID;
+        if (ws.isSettled(u)) continue;
+        ws.settle(u);
+
+        if (isTarget[u] && --remaining == 0) break;
+
+        double distU = ws.distance[u];
+        int end = csr.rowStart[u] + csr.rowDegree[u];
+        for (int k = csr.rowStart[u]; k < end; k++) {
+            int v = targets[k];
+            double candidate = distU + weights[k];
+            if (!ws.isSettled(v) && candidate < ws.getDistance(v)) {
+                ws.setDistance(v, candidate, u, k);     // Arc tag = CSR slot of the road taken
+                ws.heap.push(DijkstraNode(v, candidate));
+            }
         }
+    }
+}
+
+// Rows are dealt out round-robin so uneven search costs spread across the threads.
+// Every thread searches with its own thread-local workspace; the graph is only read.
+template <typename Task>
+inline void CityGraph::runParallel(int count, int threadCount, Task task) {
+    if (threadCount <= 0) threadCount = (int)std::thread::hardware_concurrency();
+    if (threadCount > count) threadCount = count;
+    if (threadCount <= 1) {
+        for (int i = 0; i < count; i++) task(i);
+        return;
+    }
 
-        for (int i = 0; i < path.getSize() / 2; i++) {
-            int temp = path[i];
-            path[i] = path[path.getSize() - 1 - i];
-            path[path.getSize() - 1 - i] = temp;
+    // Every started thread is joined, even when starting a later one fails: destroying a
+    // joinable std::thread terminates the program. A task that throws ends its worker's share
+    // and the first such exception is rethrown here once all workers are done.
+    Vector<std::exception_ptr> failures;
+    failures.resize(threadCount);
+    Vector<std::thread> workers;
+    workers.reserve(threadCount);
+    try {
+        for (int t = 0; t < threadCount; t++) {
+            workers.emplace_back([&task, &failures, t, count, threadCount]() {
+                try {
+                    for (int i = t; i < count; i += threadCount) task(i);
+                }
+                catch (...) {
+                    failures[t] = std::current_exception();
+                }
+            });
         }
+    }
+    catch (...) {
+        for (int t = 0; t < workers.getSize(); t++) workers[t].join();
+        throw;
+    }
 
-        totalDistance = distance[endID];
+    for (int t = 0; t < workers.getSize(); t++) workers[t].join();
+    for (int t = 0; t < threadCount; t++) {
+        if (failures[t]) std::rethrow_exception(failures[t]);
     }
+}
 
-    return path;
+inline void CityGraph::setDefaultSearchMode(RouteSearchMode mode) {
+    defaultSearchMode = (mode == RouteSearchMode::DEFAULT) ? RouteSearchMode::ASTAR : mode;
 }
 
-// ==================== FACILITY SEARCH ====================
+// Answers from the route cache when it holds a fresh entry; runSearch does the actual work
+inline Vector<int> CityGraph::searchPath(int startID, int endID, double& totalDistance,
+    const double* weights, RouteSearchMode mode) {
+    totalDistance = 0.0;
+    if (startID < 0 || startID >= nodeCount || endID < 0 || endID >= nodeCount) {
+        return Vector<int>();
+    }
 
-inline int CityGraph::findNearestFacility(int fromNodeID, const string& facilityType) {
-    if (fromNodeID < 0 || fromNodeID >= nodeCount) return -1;
+    bool dynamic = (weights != csr.weights.begin());
+    if (dynamic) flushTrafficUpdates();
 
-    double distance[MAX_NODES];
-    bool visited[MAX_NODES];
+    Vector<int> path;
+    if (routeCache.find(startID, endID, dynamic, path, totalDistance)) return path;
+
+    path = runSearch(startID, endID, totalDistance, weights, mode);
+    routeCache.store(startID, endID, dynamic, path, totalDistance);
+    return path;
+}
 
-    for (int i = 0; i < MAX_NODES; i++) {
-        distance[i] = INF;
-        visited[i] = false;
+inline Vector<int> CityGraph::runSearch(int startID, int endID, double& totalDistance,
+    const double* weights, RouteSearchMode mode) {
+    if (mode == RouteSearchMode::DEFAULT) mode = defaultSearchMode;
+
+    switch (mode) {
+        case RouteSearchMode::BIDIRECTIONAL:
+            return searchBidirectional(startID, endID, totalDistance, weights);
+        case RouteSearchMode::DIJKSTRA:
+            return searchDijkstra(startID, endID, totalDistance, weights, false);
+        case RouteSearchMode::HIERARCHY:
+            if (weights == csr.weights.begin()) {
+                if (!hierarchy.isBuilt()) buildContractionHierarchy();
+                return hierarchy.findShortestPath(startID, endID, totalDistance, getWorkspace(0), getWorkspace(1));
+            }
+            return searchDijkstra(startID, endID, totalDistance, weights, true);
+        case RouteSearchMode::SECTOR_OVERLAY:
+            return searchOverlay(startID, endID, totalDistance, weights);
+        default:
+            return searchDijkstra(startID, endID, totalDistance, weights, true);
     }
+}
+
+// Straight-line lower bound on the cost of any route between two nodes.
+// Every road costs at least minWeightPerKm per km of straight-line length (plain roads 1.0,
+// facility roads 1.3x / 1.5x, congestion only adds), so the estimate never overshoots and
+// satisfies the triangle inequality - A* stays exact with the closed-set early exit.
+inline double CityGraph::estimateDistance(int fromID, int toID) const {
+    return GeometryUtils::getCostLowerBound(nodeLat[fromID], nodeLon[fromID], nodeLat[toID], nodeLon[toID],
+        minWeightPerKm);
+}
 
-    PriorityQueue<DijkstraNode> pq;
-    distance[fromNodeID] = 0.0;
-    pq.push(DijkstraNode(fromNodeID, 0.0));
+// Unidirectional Dijkstra; with useHeuristic the queue is keyed on distance + estimate (A*)
+inline Vector<int> CityGraph::searchDijkstra(int startID, int endID, double& totalDistance,
+    const double* weights, bool useHeuristic) {
+    SearchWorkspace& ws = getWorkspace();
+    ws.begin(nodeCount);
 
-    while (!pq.empty()) {
-        DijkstraNode current = pq.top();
-        pq.pop();
+    const int* targets = csr.targets.begin();
+
+    ws.setDistance(startID, 0.0, -1);
+    ws.heap.push(DijkstraNode(startID, useHeuristic ? estimateDistance(startID, endID) : 0.0));
+
+    while (!ws.heap.empty()) {
+        DijkstraNode current = ws.heap.top();
+        ws.heap.pop();
 
         int u = current.nodeID;
-        if (visited[u]) continue;
-        visited[u] = true;
+        if (ws.isSettled(u)) continue;
+        ws.settle(u);
+
+        if (u == endID) break;
+
+        double distU = ws.distance[u];
+        int end = csr.rowStart[u] + csr.rowDegree[u];
+        for (int k = csr.rowStart[u]; k < end; k++) {
+            int v = targets[k];
+            double candidate = distU + weights[k];
 
-        if (u != fromNodeID && nodes[u] && nodes[u]->type == facilityType) {
-            return u;
+            if (!ws.isSettled(v) && candidate < ws.getDistance(v)) {
+                ws.setDistance(v, candidate, u);
+                double key = useHeuristic ? candidate + estimateDistance(v, endID) : candidate;
+                ws.heap.push(DijkstraNode(v, key));
+            }
         }
+    }
+
+    Vector<int> path = ws.tracePath(endID);
+    if (path.getSize() > 0) totalDistance = ws.distance[endID];
+    return path;
+}
+
+// Bidirectional Dijkstra: alternately expands the cheaper of a forward search from startID
+// and a backward search from endID, and stops once the two queue fronts together can no
+// longer beat the best meeting point found so far.
+// Roads are always added in pairs of equal weight and share one load (tryEnterEdge/leaveEdge),
+// so the backward search can read node u's own CSR row as its incoming edges.
+inline Vector<int> CityGraph::searchBidirectional(int startID, int endID, double& totalDistance,
+    const double* weights) {
+    Vector<int> path;
+
+    if (startID == endID) {
+        path.push_back(startID);
+        return path;
+    }
 
-        if (!nodes[u]) continue;
+    // Side 0 searches forward from startID, side 1 backward from endID
+    SearchWorkspace* ws[2] = { &getWorkspace(0), &getWorkspace(1) };
+    ws[0]->begin(nodeCount);
+    ws[1]->begin(nodeCount);
 
-        const LinkedList<Edge>& roads = nodes[u]->roads;
-        for (int i = 0; i < roads.size(); i++) {
-            int v = roads[i].destinationID;
-            double weight = roads[i].weight;
+    const int* targets = csr.targets.begin();
 
-            if (!visited[v] && distance[u] + weight < distance[v]) {
-                distance[v] = distance[u] + weight;
-                pq.push(DijkstraNode(v, distance[v]));
+    ws[0]->setDistance(startID, 0.0, -1);
+    ws[1]->setDistance(endID, 0.0, -1);
+    ws[0]->heap.push(DijkstraNode(startID, 0.0));
+    ws[1]->heap.push(DijkstraNode(endID, 0.0));
+
+    // Best complete route so far: forward tree to meetForward, one road, backward tree from meetBackward
+    double best = INF;
+    int meetForward = -1;
+    int meetBackward = -1;
+
+    while (!ws[0]->heap.empty() && !ws[1]->heap.empty()) {
+        double front0 = ws[0]->heap.top().distance;
+        double front1 = ws[1]->heap.top().distance;
+        if (front0 + front1 >= best) break;
+
+        int side = (front0 <= front1) ? 0 : 1;
+        SearchWorkspace& own = *ws[side];
+        const SearchWorkspace& other = *ws[1 - side];
+
+        DijkstraNode current = own.heap.top();
+        own.heap.pop();
+
+        int u = current.nodeID;
+        if (own.isSettled(u)) continue;
+        own.settle(u);
+
+        double distU = own.distance[u];
+        int end = csr.rowStart[u] + csr.rowDegree[u];
+        for (int k = csr.rowStart[u]; k < end; k++) {
+            int v = targets[k];
+            double candidate = distU + weights[k];
+
+            if (!own.isSettled(v) && candidate < own.getDistance(v)) {
+                own.setDistance(v, candidate, u);
+                own.heap.push(DijkstraNode(v, candidate));
+            }
+
+            // Every relaxed road into the other tree is a potential bridge
+            double remaining = other.getDistance(v);
+            if (remaining < INF && candidate + remaining < best) {
+                best = candidate + remaining;
+                meetForward = (side == 0) ? u : v;
+                meetBackward = (side == 0) ? v : u;
             }
         }
     }
 
-    return -1;
+    if (meetForward == -1) return path;
+
+    // startID ... meetForward along the forward tree, then meetBackward ... endID
+    path = ws[0]->tracePath(meetForward);
+    for (int current = meetBackward; current != -1; current = ws[1]->getParent(current)) {
+        path.push_back(current);
+    }
+
+    totalDistance = best;
+    return path;
+}
+
+// Thread-local so concurrent searches on the same graph never share scratch state
+inline SearchWorkspace& CityGraph::getWorkspace(int slot) {
+    thread_local SearchWorkspace pool[2];
+    return pool[slot];
+}
+
+// ==================== FACILITY SEARCH ====================
+
+inline void CityGraph::ensureFacilityIndex(int typeID) {
+    if (facilityIndex.isBuilt(typeID)) return;
+
+    Vector<int> sources;
+    for (int i = 0; i < nodeCount; i++) {
+        if (nodeType[i] == typeID) sources.push_back(i);
+    }
+    facilityIndex.build(typeID, csr, nodeCount, sources);
+}
+
+inline int CityGraph::findNearestFacility(int fromNodeID, const string& facilityType) {
+    if (fromNodeID < 0 || fromNodeID >= nodeCount) return -1;
+
+    // A type no node has ever used has no facilities
+    int typeID = FacilityType::lookup(facilityType);
+    if (typeID == FacilityType::ID_UNKNOWN) return -1;
+
+    ensureFacilityIndex(typeID);
+    return facilityIndex.nearest(typeID, fromNodeID);
 }
 
 inline Vector<int> CityGraph::findAllNearestFacilities(int fromNodeID, const string& facilityType, int maxCount) {
     Vector<int> results;
     if (fromNodeID < 0 || fromNodeID >= nodeCount) return results;
 
-    double distance[MAX_NODES];
-    bool visited[MAX_NODES];
+    int typeID = FacilityType::lookup(facilityType);
+    if (typeID == FacilityType::ID_UNKNOWN) return results;
 
-    for (int i = 0; i < MAX_NODES; i++) {
-        distance[i] = INF;
-        visited[i] = false;
+    // The index keeps K labels per node, one of which may be the node itself
+    if (maxCount <= FACILITY_INDEX_K - 1) {
+        ensureFacilityIndex(typeID);
+        return facilityIndex.kNearest(typeID, fromNodeID, maxCount);
     }
 
-    PriorityQueue<DijkstraNode> pq;
-    distance[fromNodeID] = 0.0;
-    pq.push(DijkstraNode(fromNodeID, 0.0));
+    SearchWorkspace& ws = getWorkspace();
+    ws.begin(nodeCount);
+
+    const int* targets = csr.targets.begin();
+    const double* weights = csr.weights.begin();
 
-    while (!pq.empty() && results.getSize() < maxCount) {
-        DijkstraNode current = pq.top();
-        pq.pop();
+    ws.setDistance(fromNodeID, 0.0, -1);
+    ws.heap.push(DijkstraNode(fromNodeID, 0.0));
+
+    while (!ws.heap.empty() && results.getSize() < maxCount) {
+        DijkstraNode current = ws.heap.top();
+        ws.heap.pop();
 
         int u = current.nodeID;
-        if (visited[u]) continue;
-        visited[u] = true;
+        if (ws.isSettled(u)) continue;
+        ws.settle(u);
 
-        if (u != fromNodeID && nodes[u] && nodes[u]->type == facilityType) {
+        if (u != fromNodeID && nodeType[u] == typeID) {
             results.push_back(u);
         }
 
-        if (!nodes[u]) continue;
-
-        const LinkedList<Edge>& roads = nodes[u]->roads;
-        for (int i = 0; i < roads.size(); i++) {
-            int v = roads[i].destinationID;
-            double weight = roads[i].weight;
+        double distU = ws.distance[u];
+        int end = csr.rowStart[u] + csr.rowDegree[u];
+        for (int k = csr.rowStart[u]; k < end; k++) {
+            int v = targets[k];
+            double candidate = distU + weights[k];
 
-            if (!visited[v] && distance[u] + weight < distance[v]) {
-                distance[v] = distance[u] + weight;
-                pq.push(DijkstraNode(v, distance[v]));
+            if (!ws.isSettled(v) && candidate < ws.getDistance(v)) {
+                ws.setDistance(v, candidate, u);
+                ws.heap.push(DijkstraNode(v, candidate));
             }
         }
     }
@@ -1136,41 +2173,158 @@ inline Vector<int> CityGraph::findAllNearestFacilities(int fromNodeID, const str
 }
 
 inline Vector<int> CityGraph::calculateBusRoute(int startNodeID, int endNodeID, double& distance) {
-    return findShortestPath(startNodeID, endNodeID, distance);
+    return findShortestPath(startNodeID, endNodeID, distance, RouteSearchMode::HIERARCHY);
 }
 
-// ==================== LOOKUP FUNCTIONS ====================
+// ==================== SECTOR OVERLAY ====================
 
-inline int CityGraph::getIDByName(const string& name) {
+inline void CityGraph::buildSectorOverlay() {
+    Vector<int> cells;
+    cells.resize(nodeCount, OVERLAY_CELL_COUNT - 1);
     for (int i = 0; i < nodeCount; i++) {
-        if (nodes[i] && nodes[i]->name == name) return i;
+        if (nodeSector[i] >= 0) cells[i] = nodeSector[i];
     }
-    return -1;
+    overlay.build(csr, cells, getWorkspace());
 }
 
-inline int CityGraph::getIDByDatabaseID(const string& dbID) {
-    for (int i = 0; i < nodeCount; i++) {
-        if (nodes[i] && nodes[i]->databaseID == dbID) return i;
+// Two-level A*: nodes in the start and end sectors relax their roads as usual, while a node
+// of any other sector (only ever reached as a boundary node, via a road crossing into it)
+// hops straight to the other boundary nodes of its sector over the precomputed clique arcs
+// and leaves over its own crossing roads. The clique arcs are exact within-sector distances
+// and still satisfy the straight-line bound, so the result matches a full search.
+inline Vector<int> CityGraph::searchOverlay(int startID, int endID, double& totalDistance,
+    const double* weights) {
+    bool dynamic = (weights != csr.weights.begin());
+    if (!overlay.isBuilt()) buildSectorOverlay();
+    if (dynamic) overlay.ensureDynamic(csr, getWorkspace());
+
+    SearchWorkspace& ws = getWorkspace();
+    ws.begin(nodeCount);
+
+    const int* targets = csr.targets.begin();
+    int startCell = overlay.getCell(startID);
+    int endCell = overlay.getCell(endID);
+
+    ws.setDistance(startID, 0.0, -1);
+    ws.heap.push(DijkstraNode(startID, estimateDistance(startID, endID)));
+
+    while (!ws.heap.empty()) {
+        DijkstraNode current = ws.heap.top();
+        ws.heap.pop();
+
+        int u = current.nodeID;
+        if (ws.isSettled(u)) continue;
+        ws.settle(u);
+
+        if (u == endID) break;
+
+        double distU = ws.distance[u];
+        int cell = overlay.getCell(u);
+        bool expanded = (cell == startCell || cell == endCell);
+
+        if (!expanded) {
+            const Vector<SectorOverlay::Arc>& arcs = overlay.getCliqueArcs(u, dynamic);
+            for (int j = 0; j < arcs.getSize(); j++) {
+                int v = arcs[j].target;
+                double candidate = distU + arcs[j].weight;
+                if (!ws.isSettled(v) && candidate < ws.getDistance(v)) {
+                    ws.setDistance(v, candidate, u, OVERLAY_CLIQUE_ARC);
+                    ws.heap.push(DijkstraNode(v, candidate + estimateDistance(v, endID)));
+                }
+            }
+        }
+
+        int end = csr.rowStart[u] + csr.rowDegree[u];
+        for (int k = csr.rowStart[u]; k < end; k++) {
+            int v = targets[k];
+            if (!expanded && overlay.getCell(v) == cell) continue;
+
+            double candidate = distU + weights[k];
+            if (!ws.isSettled(v) && candidate < ws.getDistance(v)) {
+                ws.setDistance(v, candidate, u);
+                ws.heap.push(DijkstraNode(v, candidate + estimateDistance(v, endID)));
+            }
+        }
     }
-    return -1;
+
+    // Record the hops before the workspace is reused to unpack the clique arcs
+    Vector<int> hops = ws.tracePath(endID);
+    if (hops.getSize() == 0) return hops;
+    totalDistance = ws.distance[endID];
+
+    Vector<bool> viaClique;
+    viaClique.resize(hops.getSize(), false);
+    for (int i = 1; i < hops.getSize(); i++) {
+        viaClique[i] = (ws.getParentArc(hops[i]) == OVERLAY_CLIQUE_ARC);
+    }
+
+    Vector<int> path;
+    path.push_back(hops[0]);
+    for (int i = 1; i < hops.getSize(); i++) {
+        if (viaClique[i]) overlay.expandClique(csr, weights, hops[i - 1], hops[i], ws, path);
+        else path.push_back(hops[i]);
+    }
+    return path;
 }
 
-inline int CityGraph::getIDByStopID(const string& sID) {
-    for (int i = 0; i < nodeCount; i++) {
-        if (nodes[i] && nodes[i]->stopID == sID) return i;
+// ==================== CONTRACTION HIERARCHY ====================
+
+inline void CityGraph::buildContractionHierarchy() {
+    // Ordering hint from the sector skeleton: facility nodes go first, then interior
+    // corners, and the boundary corners that carry highways and sector stitching go last
+    Vector<int> importance;
+    importance.resize(nodeCount, 0);
+    for (int s = 0; s < SECTOR_COUNT; s++) {
+        if (!SECTOR_GRID[s].initialized) continue;
+        for (int r = 0; r < 5; r++) {
+            for (int c = 0; c < 5; c++) {
+                int id = SECTOR_GRID[s].gridCorners[r][c];
+                if (id < 0 || id >= nodeCount) continue;
+                bool isBoundary = (r == 0 || r == 4 || c == 0 || c == 4);
+                importance[id] = isBoundary ? 2 : 1;
+            }
+        }
     }
-    return -1;
+
+    hierarchy.build(csr, nodeCount, importance, getWorkspace());
+}
+
+// ==================== LOOKUP FUNCTIONS ====================
+
+// Answered from the indexes filled in createNodeRaw (nodes are never renamed or deleted)
+
+inline int CityGraph::getIDByName(const string& name) {
+    int* id = nameIndex.get(name);
+    return id ? *id : -1;
+}
+
+inline int CityGraph::getIDByDatabaseID(const string& dbID) {
+    int* id = databaseIDIndex.get(dbID);
+    return id ? *id : -1;
+}
+
+inline int CityGraph::getIDByStopID(const string& sID) {
+    int* id = stopIDIndex.get(sID);
+    return id ? *id : -1;
 }
 
 // ==================== QUERY FUNCTIONS ====================
 
+// Sector and type names are resolved to their IDs once; the scans compare ints.
+// Nodes outside every sector match the sector name "Unknown" (index -1).
 inline Vector<int> CityGraph::getFacilitiesInSector(const string& sector, const string& type) {
     Vector<int> results;
+    int sectorIdx = GeometryUtils::getSectorIndex(sector);
+    if (sectorIdx == -1 && sector != "Unknown") return results;
+
+    int typeID = type.empty() ? FacilityType::ID_UNKNOWN : FacilityType::lookup(type);
+    if (!type.empty() && typeID == FacilityType::ID_UNKNOWN) return results;
+
     for (int i = 0; i < nodeCount; i++) {
-        if (!nodes[i] || nodes[i]->sector != sector || nodes[i]->type == FacilityType::CORNER) {
+        if (nodeSector[i] != sectorIdx || nodeType[i] == FacilityType::ID_CORNER) {
             continue;
         }
-        if (type.empty() || nodes[i]->type == type) {
+        if (type.empty() || nodeType[i] == typeID) {
             results.push_back(i);
         }
     }
@@ -1179,8 +2333,11 @@ inline Vector<int> CityGraph::getFacilitiesInSector(const string& sector, const
 
 inline Vector<int> CityGraph::getAllStopsInSector(const string& sector) {
     Vector<int> results;
+    int sectorIdx = GeometryUtils::getSectorIndex(sector);
+    if (sectorIdx == -1 && sector != "Unknown") return results;
+
     for (int i = 0; i < nodeCount; i++) {
-        if (nodes[i] && nodes[i]->sector == sector && nodes[i]->canBeTransportStop()) {
+        if (nodeSector[i] == sectorIdx && FacilityType::isTransportStop(nodeType[i])) {
             results.push_back(i);
         }
     }
@@ -9,16 +9,13 @@ using namespace std;
 
 const int INF = 1e9;
 
-// Increased node capacity to support 4x4 sub-grid skeleton (25 corner nodes per sector)
-// 25 corners * 30 sectors = 750 nodes just for infrastructure.
-// Plus 16 subsectors * 4 nodes = 64 nodes capacity per sector.
-#define MAX_NODES 5000
 #define SECTOR_COUNT 30
 #define MAX_ROADS_PER_NODE 10
 #define MAX_SCHOOLS_PER_SECTOR 5
 #define MAX_HOSPITALS_PER_SECTOR 5
 #define MAX_MALLS_PER_SECTOR 5
 #define MAX_PUBLIC_FACILITIES_PER_SECTOR 20
+#define NODE_LOOKUP_RESERVE 2048     // Nodes CityGraph's name / databaseID / stopID indexes hold before growing
 
 const double KM_PER_LAT_DEGREE = 111.0;
 const double KM_PER_LON_DEGREE = 92.0;
@@ -47,36 +44,101 @@ namespace FacilityType {
     const string RESTAURANT = "RESTAURANT";
     const string PUBLIC_TOILET = "PUBLIC_TOILET";
 
+    // Interned type IDs: the built-in types have fixed IDs that index the tables below;
+    // any other type string is given the next free ID the first time it is interned.
+    // Hot loops compare these ints; the strings above remain the public names.
+    enum ID : int {
+        ID_STOP, ID_CORNER, ID_SCHOOL, ID_HOSPITAL, ID_PHARMACY, ID_MALL, ID_SHOP, ID_HOUSE,
+        ID_MOSQUE, ID_PARK, ID_WATER_COOLER, ID_PLAYGROUND, ID_LIBRARY, ID_COMMUNITY_CENTER,
+        ID_POLICE_STATION, ID_FIRE_STATION, ID_POST_OFFICE, ID_BANK, ID_ATM, ID_PETROL_STATION,
+        ID_RESTAURANT, ID_PUBLIC_TOILET,
+        BUILTIN_COUNT
+    };
+    constexpr int ID_UNKNOWN = -1;
+
+    constexpr const char* NAMES[BUILTIN_COUNT] = {
+        "STOP", "CORNER", "SCHOOL", "HOSPITAL", "PHARMACY", "MALL", "SHOP", "HOUSE",
+        "MOSQUE", "PARK", "WATER_COOLER", "PLAYGROUND", "LIBRARY", "COMMUNITY_CENTER",
+        "POLICE_STATION", "FIRE_STATION", "POST_OFFICE", "BANK", "ATM", "PETROL_STATION",
+        "RESTAURANT", "PUBLIC_TOILET"
+    };
+
+    constexpr const char* STOP_ID_PREFIXES[BUILTIN_COUNT] = {
+        "STP", "FAC", "FAC", "FAC", "FAC", "FAC", "FAC", "HSE",
+        "MSQ", "PRK", "WTR", "PLY", "LIB", "COM",
+        "POL", "FIR", "PST", "BNK", "ATM", "PET",
+        "RST", "TOI"
+    };
+
+    constexpr bool IS_PUBLIC[BUILTIN_COUNT] = {
+        false, false, false, false, false, false, false, false,
+        true, true, true, true, true, true,
+        true, true, true, true, true, true,
+        true, true
+    };
+
+    // Slot in CityGraph's per-type stop ID counters (public facilities; everything else shares 0)
+    constexpr int COUNTER_INDEX[BUILTIN_COUNT] = {
+        0, 0, 0, 0, 0, 0, 0, 0,
+        0, 1, 2, 3, 4, 5,
+        6, 7, 8, 9, 10, 11,
+        12, 13
+    };
+    constexpr int COUNTER_COUNT = 14;
+
+    // Names of non-built-in types, in ID order starting at BUILTIN_COUNT
+    inline Vector<string>& customNames() {
+        static Vector<string> names;
+        return names;
+    }
+
+    // ID of a type name, or ID_UNKNOWN if it was never interned
+    inline int lookup(const string& type) {
+        for (int i = 0; i < BUILTIN_COUNT; i++) {
+            if (type == NAMES[i]) return i;
+        }
+        const Vector<string>& custom = customNames();
+        for (int i = 0; i < custom.getSize(); i++) {
+            if (custom[i] == type) return BUILTIN_COUNT + i;
+        }
+        return ID_UNKNOWN;
+    }
+
+    inline int intern(const string& type) {
+        int id = lookup(type);
+        if (id != ID_UNKNOWN) return id;
+        customNames().push_back(type);
+        return BUILTIN_COUNT + customNames().getSize() - 1;
+    }
+
+    inline string nameOf(int id) {
+        if (id >= 0 && id < BUILTIN_COUNT) return NAMES[id];
+        if (id >= BUILTIN_COUNT && id - BUILTIN_COUNT < customNames().getSize()) return customNames()[id - BUILTIN_COUNT];
+        return "";
+    }
+
+    constexpr bool isPublicFacility(int id) {
+        return id >= 0 && id < BUILTIN_COUNT && IS_PUBLIC[id];
+    }
+
+    constexpr bool isTransportStop(int id) {
+        return id == ID_STOP || isPublicFacility(id);
+    }
+
+    constexpr const char* getStopIDPrefix(int id) {
+        return (id >= 0 && id < BUILTIN_COUNT) ? STOP_ID_PREFIXES[id] : "FAC";
+    }
+
     inline bool isPublicFacility(const string& type) {
-        return type == MOSQUE || type == PARK || type == WATER_COOLER ||
-            type == PLAYGROUND || type == LIBRARY || type == COMMUNITY_CENTER ||
-            type == POLICE_STATION || type == FIRE_STATION || type == POST_OFFICE ||
-            type == BANK || type == ATM || type == PETROL_STATION ||
-            type == RESTAURANT || type == PUBLIC_TOILET;
+        return isPublicFacility(lookup(type));
     }
 
     inline bool isTransportStop(const string& type) {
-        return type == STOP || isPublicFacility(type);
+        return isTransportStop(lookup(type));
     }
 
     inline string getStopIDPrefix(const string& type) {
-        if (type == MOSQUE) return "MSQ";
-        if (type == PARK) return "PRK";
-        if (type == WATER_COOLER) return "WTR";
-        if (type == PLAYGROUND) return "PLY";
-        if (type == LIBRARY) return "LIB";
-        if (type == COMMUNITY_CENTER) return "COM";
-        if (type == POLICE_STATION) return "POL";
-        if (type == FIRE_STATION) return "FIR";
-        if (type == POST_OFFICE) return "PST";
-        if (type == BANK) return "BNK";
-        if (type == ATM) return "ATM";
-        if (type == PETROL_STATION) return "PET";
-        if (type == RESTAURANT) return "RST";
-        if (type == PUBLIC_TOILET) return "TOI";
-        if (type == STOP) return "STP";
-        if (type == HOUSE) return "HSE";
-        return "FAC";
+        return getStopIDPrefix(lookup(type));
     }
 }
 
@@ -109,6 +171,118 @@ struct SubSubSector {
     double getHeight() const { return maxLat - minLat; }
 };
 
+// ISLAMABAD SECTOR GRID
+// Sectors sit on a regular SECTOR_SIZE_LAT x SECTOR_SIZE_LON lattice anchored at
+// BASE_LAT / BASE_LON: series letters run north to south (E..I), numbers west to east.
+constexpr double SECTOR_SIZE_LAT = 0.02;
+constexpr double SECTOR_SIZE_LON = 0.02;
+constexpr double BASE_LAT = 33.64;
+constexpr double BASE_LON = 73.00;
+constexpr double MAX_LAT = 33.74;
+constexpr double MAX_LON = 73.18;
+
+constexpr int SECTOR_LOOKUP_ROWS = 5;   // (MAX_LAT - BASE_LAT) / SECTOR_SIZE_LAT
+constexpr int SECTOR_LOOKUP_COLS = 9;   // (MAX_LON - BASE_LON) / SECTOR_SIZE_LON
+constexpr char SECTOR_FIRST_SERIES = 'E';
+constexpr char SECTOR_LAST_SERIES = 'I';  // Lattice row 0
+constexpr int SECTOR_FIRST_NUMBER = 6;    // Lattice column 0
+
+// Southern edge of each lattice row (written out: BASE_LAT + row * SECTOR_SIZE_LAT rounds differently)
+constexpr double SECTOR_ROW_LAT[SECTOR_LOOKUP_ROWS] = { 33.64, 33.66, 33.68, 33.70, 33.72 };
+
+// Fixed geometry of one sector, derived from its name ("F-7") at compile time
+struct SectorLayout {
+    const char* name;
+    int row, col;           // Lattice square (row 0 = I series, col 0 = number 6)
+    double minLat, maxLat;
+    double minLon, maxLon;
+
+    constexpr SectorLayout(const char* n)
+        : name(n), row(SECTOR_LAST_SERIES - n[0]), col(parseNumber(n) - SECTOR_FIRST_NUMBER),
+        minLat(SECTOR_ROW_LAT[SECTOR_LAST_SERIES - n[0]]),
+        maxLat(SECTOR_ROW_LAT[SECTOR_LAST_SERIES - n[0]] + SECTOR_SIZE_LAT),
+        minLon(BASE_LON + (parseNumber(n) - SECTOR_FIRST_NUMBER) * SECTOR_SIZE_LON),
+        maxLon(BASE_LON + (parseNumber(n) - SECTOR_FIRST_NUMBER) * SECTOR_SIZE_LON + SECTOR_SIZE_LON) {
+    }
+
+    static constexpr int parseNumber(const char* n) {
+        int number = 0;
+        for (int i = 2; n[i] != '\0'; i++) {
+            number = number * 10 + (n[i] - '0');
+        }
+        return number;
+    }
+};
+
+inline constexpr SectorLayout SECTOR_LAYOUT[SECTOR_COUNT] = {
+    // E-SERIES
+    "E-7", "E-8", "E-9", "E-10", "E-11",
+    // F-SERIES
+    "F-6", "F-7", "F-8", "F-9", "F-10", "F-11",
+    // G-SERIES
+    "G-6", "G-7", "G-8", "G-9", "G-10", "G-11",
+    // H-SERIES
+    "H-8", "H-9", "H-10", "H-11", "H-12", "H-13",
+    // I-SERIES
+    "I-8", "I-9", "I-10", "I-11", "I-12", "I-13", "I-14"
+};
+
+// Lattice lookups and neighbour lists over SECTOR_LAYOUT indices, built at compile time
+struct SectorTopology {
+    int at[SECTOR_LOOKUP_ROWS][SECTOR_LOOKUP_COLS];  // Lattice square -> sector (-1 = none)
+
+    // Sectors touching a sector, edges or corners, in index order
+    int adjacent[SECTOR_COUNT][8];
+    int adjacentCount[SECTOR_COUNT];
+
+    // Sectors sharing a full edge, west / east / north / south
+    int bordering[SECTOR_COUNT][4];
+    int borderingCount[SECTOR_COUNT];
+
+    bool valid;     // Every sector on its own lattice square
+
+    constexpr SectorTopology() : at(), adjacent(), adjacentCount(), bordering(), borderingCount(), valid(true) {
+        for (int r = 0; r < SECTOR_LOOKUP_ROWS; r++) {
+            for (int c = 0; c < SECTOR_LOOKUP_COLS; c++) {
+                at[r][c] = -1;
+            }
+        }
+        for (int i = 0; i < SECTOR_COUNT; i++) {
+            int r = SECTOR_LAYOUT[i].row;
+            int c = SECTOR_LAYOUT[i].col;
+            if (r < 0 || r >= SECTOR_LOOKUP_ROWS || c < 0 || c >= SECTOR_LOOKUP_COLS || at[r][c] != -1) valid = false;
+            else at[r][c] = i;
+        }
+
+        for (int i = 0; i < SECTOR_COUNT; i++) {
+            int r = SECTOR_LAYOUT[i].row;
+            int c = SECTOR_LAYOUT[i].col;
+            for (int j = 0; j < SECTOR_COUNT; j++) {
+                int dr = SECTOR_LAYOUT[j].row - r;
+                int dc = SECTOR_LAYOUT[j].col - c;
+                if (j != i && dr >= -1 && dr <= 1 && dc >= -1 && dc <= 1) {
+                    adjacent[i][adjacentCount[i]++] = j;
+                }
+            }
+
+            const int stepRow[4] = { 0, 0, 1, -1 };
+            const int stepCol[4] = { -1, 1, 0, 0 };
+            for (int k = 0; k < 4; k++) {
+                int j = lookup(r + stepRow[k], c + stepCol[k]);
+                if (j != -1) bordering[i][borderingCount[i]++] = j;
+            }
+        }
+    }
+
+    constexpr int lookup(int row, int col) const {
+        if (row < 0 || row >= SECTOR_LOOKUP_ROWS || col < 0 || col >= SECTOR_LOOKUP_COLS) return -1;
+        return at[row][col];
+    }
+};
+
+inline constexpr SectorTopology SECTOR_TOPOLOGY{};
+static_assert(SECTOR_TOPOLOGY.valid, "SECTOR_LAYOUT: every sector needs its own square inside the lookup lattice");
+
 // SECTOR BOX
 struct SectorBox {
     string name;
@@ -132,6 +306,10 @@ struct SectorBox {
         resetGrid();
     }
 
+    SectorBox(const SectorLayout& layout)
+        : SectorBox(layout.name, layout.minLat, layout.maxLat, layout.minLon, layout.maxLon) {
+    }
+
     void resetGrid() {
         // Reset cells
         for (int i = 0; i < 16; i++) {
@@ -156,86 +334,64 @@ struct SectorBox {
     }
 };
 
-// ISLAMABAD SECTOR GRID
-
-
-const double SECTOR_SIZE_LAT = 0.02;
-const double SECTOR_SIZE_LON = 0.02;
-const double BASE_LAT = 33.64;
-const double BASE_LON = 73.00;
-const double MAX_LAT = 33.74;
-const double MAX_LON = 73.18;
+// Runtime state of every sector (skeleton nodes, cell occupancy), in SECTOR_LAYOUT order
+inline SectorBox SECTOR_GRID[SECTOR_COUNT] = {
+    SECTOR_LAYOUT[0], SECTOR_LAYOUT[1], SECTOR_LAYOUT[2], SECTOR_LAYOUT[3], SECTOR_LAYOUT[4],
+    SECTOR_LAYOUT[5], SECTOR_LAYOUT[6], SECTOR_LAYOUT[7], SECTOR_LAYOUT[8], SECTOR_LAYOUT[9],
+    SECTOR_LAYOUT[10], SECTOR_LAYOUT[11], SECTOR_LAYOUT[12], SECTOR_LAYOUT[13], SECTOR_LAYOUT[14],
+    SECTOR_LAYOUT[15], SECTOR_LAYOUT[16], SECTOR_LAYOUT[17], SECTOR_LAYOUT[18], SECTOR_LAYOUT[19],
+    SECTOR_LAYOUT[20], SECTOR_LAYOUT[21], SECTOR_LAYOUT[22], SECTOR_LAYOUT[23], SECTOR_LAYOUT[24],
+    SECTOR_LAYOUT[25], SECTOR_LAYOUT[26], SECTOR_LAYOUT[27], SECTOR_LAYOUT[28], SECTOR_LAYOUT[29]
+};
 
 // ==================== ROAD CAPACITY CONSTANTS ====================
 constexpr int DEFAULT_ROAD_CAPACITY = 10;      // Internal sector roads
 constexpr int HIGHWAY_ROAD_CAPACITY = 40;      // Sector boundary roads (main highways)
 constexpr int FACILITY_ROAD_CAPACITY = 5;      // Small access roads to facilities
 
-#define COL_LON(col) (73.00 + ((col) - 6) * 0.02)
-#define ROW_E_LAT 33.72
-#define ROW_F_LAT 33.70
-#define ROW_G_LAT 33.68
-#define ROW_H_LAT 33.66
-#define ROW_I_LAT 33.64
-
-static SectorBox SECTOR_GRID[] = {
-    // E-SERIES
-    {"E-7",  ROW_E_LAT, ROW_E_LAT + 0.02, COL_LON(7),  COL_LON(7) + 0.02},
-    {"E-8",  ROW_E_LAT, ROW_E_LAT + 0.02, COL_LON(8),  COL_LON(8) + 0.02},
-    {"E-9",  ROW_E_LAT, ROW_E_LAT + 0.02, COL_LON(9),  COL_LON(9) + 0.02},
-    {"E-10", ROW_E_LAT, ROW_E_LAT + 0.02, COL_LON(10), COL_LON(10) + 0.02},
-    {"E-11", ROW_E_LAT, ROW_E_LAT + 0.02, COL_LON(11), COL_LON(11) + 0.02},
-
-    // F-SERIES
-    {"F-6",  ROW_F_LAT, ROW_F_LAT + 0.02, COL_LON(6),  COL_LON(6) + 0.02},
-    {"F-7",  ROW_F_LAT, ROW_F_LAT + 0.02, COL_LON(7),  COL_LON(7) + 0.02},
-    {"F-8",  ROW_F_LAT, ROW_F_LAT + 0.02, COL_LON(8),  COL_LON(8) + 0.02},
-    {"F-9",  ROW_F_LAT, ROW_F_LAT + 0.02, COL_LON(9),  COL_LON(9) + 0.02},
-    {"F-10", ROW_F_LAT, ROW_F_LAT + 0.02, COL_LON(10), COL_LON(10) + 0.02},
-    {"F-11", ROW_F_LAT, ROW_F_LAT + 0.02, COL_LON(11), COL_LON(11) + 0.02},
-
-    // G-SERIES 
-    {"G-6",  ROW_G_LAT, ROW_G_LAT + 0.02, COL_LON(6),  COL_LON(6) + 0.02},
-    {"G-7",  ROW_G_LAT, ROW_G_LAT + 0.02, COL_LON(7),  COL_LON(7) + 0.02},
-    {"G-8",  ROW_G_LAT, ROW_G_LAT + 0.02, COL_LON(8),  COL_LON(8) + 0.02},
-    {"G-9",  ROW_G_LAT, ROW_G_LAT + 0.02, COL_LON(9),  COL_LON(9) + 0.02},
-    {"G-10", ROW_G_LAT, ROW_G_LAT + 0.02, COL_LON(10), COL_LON(10) + 0.02},
-    {"G-11", ROW_G_LAT, ROW_G_LAT + 0.02, COL_LON(11), COL_LON(11) + 0.02},
-
-    // H-SERIES 
-    {"H-8",  ROW_H_LAT, ROW_H_LAT + 0.02, COL_LON(8),  COL_LON(8) + 0.02},
-    {"H-9",  ROW_H_LAT, ROW_H_LAT + 0.02, COL_LON(9),  COL_LON(9) + 0.02},
-    {"H-10", ROW_H_LAT, ROW_H_LAT + 0.02, COL_LON(10), COL_LON(10) + 0.02},
-    {"H-11", ROW_H_LAT, ROW_H_LAT + 0.02, COL_LON(11), COL_LON(11) + 0.02},
-    {"H-12", ROW_H_LAT, ROW_H_LAT + 0.02, COL_LON(12), COL_LON(12) + 0.02},
-    {"H-13", ROW_H_LAT, ROW_H_LAT + 0.02, COL_LON(13), COL_LON(13) + 0.02},
-
-    // I-SERIES 
-    {"I-8",  ROW_I_LAT, ROW_I_LAT + 0.02, COL_LON(8),  COL_LON(8) + 0.02},
-    {"I-9",  ROW_I_LAT, ROW_I_LAT + 0.02, COL_LON(9),  COL_LON(9) + 0.02},
-    {"I-10", ROW_I_LAT, ROW_I_LAT + 0.02, COL_LON(10), COL_LON(10) + 0.02},
-    {"I-11", ROW_I_LAT, ROW_I_LAT + 0.02, COL_LON(11), COL_LON(11) + 0.02},
-    {"I-12", ROW_I_LAT, ROW_I_LAT + 0.02, COL_LON(12), COL_LON(12) + 0.02},
-    {"I-13", ROW_I_LAT, ROW_I_LAT + 0.02, COL_LON(13), COL_LON(13) + 0.02},
-    {"I-14", ROW_I_LAT, ROW_I_LAT + 0.02, COL_LON(14), COL_LON(14) + 0.02}
-};
-
-
 class GeometryUtils {
 public:
     static string resolveSector(double lat, double lon) {
-        for (int i = 0; i < SECTOR_COUNT; i++) {
-            if (SECTOR_GRID[i].containsPoint(lat, lon)) {
-                return SECTOR_GRID[i].name;
-            }
+        int idx = resolveSectorIndex(lat, lon);
+        return (idx != -1) ? SECTOR_GRID[idx].name : "Unknown";
+    }
+
+    // SECTOR_GRID index of the sector containing a point (-1 = "Unknown").
+    // Half-open boxes win over closed ones (points on an outer edge), lowest index first.
+    // Only the 3x3 lattice squares around the point are checked: rounding at shared edges
+    // can put a point in a neighbour's box, never further away.
+    static int resolveSectorIndex(double lat, double lon) {
+        if (!(lat >= BASE_LAT - SECTOR_SIZE_LAT && lat <= MAX_LAT + SECTOR_SIZE_LAT &&
+            lon >= BASE_LON - SECTOR_SIZE_LON && lon <= MAX_LON + SECTOR_SIZE_LON)) {
+            return -1;
         }
-        for (int i = 0; i < SECTOR_COUNT; i++) {
-            if (lat >= SECTOR_GRID[i].minLat && lat <= SECTOR_GRID[i].maxLat &&
-                lon >= SECTOR_GRID[i].minLon && lon <= SECTOR_GRID[i].maxLon) {
-                return SECTOR_GRID[i].name;
+
+        int row = (int)std::floor((lat - BASE_LAT) / SECTOR_SIZE_LAT);
+        int col = (int)std::floor((lon - BASE_LON) / SECTOR_SIZE_LON);
+
+        int halfOpen = -1;
+        int closed = -1;
+        for (int r = row - 1; r <= row + 1; r++) {
+            for (int c = col - 1; c <= col + 1; c++) {
+                int i = SECTOR_TOPOLOGY.lookup(r, c);
+                if (i == -1) continue;
+
+                const SectorBox& box = SECTOR_GRID[i];
+                if (box.containsPoint(lat, lon)) {
+                    if (halfOpen == -1 || i < halfOpen) halfOpen = i;
+                }
+                else if (lat >= box.minLat && lat <= box.maxLat && lon >= box.minLon && lon <= box.maxLon) {
+                    if (closed == -1 || i < closed) closed = i;
+                }
             }
         }
-        return "Unknown";
+        return (halfOpen != -1) ? halfOpen : closed;
+    }
+
+    // Sector and 4x4 sub-sector cell of a point in one step (cell -1 if outside every sector)
+    static int resolveSubSectorIndex(double lat, double lon, int& sectorIndex) {
+        sectorIndex = resolveSectorIndex(lat, lon);
+        return (sectorIndex != -1) ? getSubSectorIndex(lat, lon, SECTOR_GRID[sectorIndex]) : -1;
     }
 
     static double getGridDistance(double lat1, double lon1, double lat2, double lon2) {
@@ -244,17 +400,32 @@ public:
         return std::sqrt(dLat * dLat + dLon * dLon);
     }
 
+    // Lower bound on the cost of any route between two points when every road costs at least
+    // weightPerKm per km of straight-line length (weightPerKm >= INF: no bound known)
+    static double getCostLowerBound(double lat1, double lon1, double lat2, double lon2, double weightPerKm) {
+        if (weightPerKm >= INF) return 0.0;
+        // Shave a hair off so rounding in the ratio can never make the bound inconsistent
+        return getGridDistance(lat1, lon1, lat2, lon2) * weightPerKm * 0.999999;
+    }
+
     static double getManhattanDistance(double lat1, double lon1, double lat2, double lon2) {
         double dLat = std::abs(lat2 - lat1) * KM_PER_LAT_DEGREE;
         double dLon = std::abs(lon2 - lon1) * KM_PER_LON_DEGREE;
         return dLat + dLon;
     }
 
+    // Parses "<series>-<number>" straight to its lattice square; no table scan
     static int getSectorIndex(const string& name) {
-        for (int i = 0; i < SECTOR_COUNT; i++) {
-            if (SECTOR_GRID[i].name == name) return i;
+        int length = (int)name.length();
+        if (length < 3 || length > 4 || name[1] != '-') return -1;
+
+        int number = 0;
+        for (int i = 2; i < length; i++) {
+            if (name[i] < '0' || name[i] > '9') return -1;
+            number = number * 10 + (name[i] - '0');
         }
-        return -1;
+        int idx = SECTOR_TOPOLOGY.lookup(SECTOR_LAST_SERIES - name[0], number - SECTOR_FIRST_NUMBER);
+        return (idx != -1 && name == SECTOR_LAYOUT[idx].name) ? idx : -1;   // Rejects "F-07"
     }
 
     // Maps a coordinate to the specific 4x4 sub-grid cell index (0-15)
@@ -323,23 +494,14 @@ public:
         return (idx != -1) ? &SECTOR_GRID[idx] : nullptr;
     }
 
+    // Names of SECTOR_TOPOLOGY.adjacent (edge or corner neighbours); index callers read the table
     static Vector<string> getAdjacentSectors(const string& sectorName) {
         Vector<string> adjacent;
         int idx = getSectorIndex(sectorName);
         if (idx == -1) return adjacent;
 
-        double centerLat = SECTOR_GRID[idx].getCenterLat();
-        double centerLon = SECTOR_GRID[idx].getCenterLon();
-
-        for (int i = 0; i < SECTOR_COUNT; i++) {
-            if (i == idx) continue;
-
-            double latDiff = std::abs(centerLat - SECTOR_GRID[i].getCenterLat());
-            double lonDiff = std::abs(centerLon - SECTOR_GRID[i].getCenterLon());
-
-            if (latDiff <= SECTOR_SIZE_LAT * 1.1 && lonDiff <= SECTOR_SIZE_LON * 1.1) {
-                adjacent.push_back(SECTOR_GRID[i].name);
-            }
+        for (int k = 0; k < SECTOR_TOPOLOGY.adjacentCount[idx]; k++) {
+            adjacent.push_back(SECTOR_GRID[SECTOR_TOPOLOGY.adjacent[idx][k]].name);
         }
         return adjacent;
     }
@@ -360,20 +522,25 @@ public:
 struct Edge {
     int destinationID;
     double weight;          // Base distance in km
+
+    // Dense handles assigned by CityGraph when the road is added (-1 until then)
+    int id;
+    int reverseID;          // The opposite direction of the same road
     
     // Traffic simulation fields
     int capacity;           // Max vehicles on this road segment
     int currentLoad;        // Current vehicle count
     double dynamicWeight;   // Used for pathfinding, increases with congestion
+    bool trafficDirty;      // Load changed since dynamicWeight was last recomputed
 
-    Edge() : destinationID(-1), weight(0.0), 
-             capacity(DEFAULT_ROAD_CAPACITY), currentLoad(0), dynamicWeight(0.0) {}
+    Edge() : destinationID(-1), weight(0.0), id(-1), reverseID(-1),
+             capacity(DEFAULT_ROAD_CAPACITY), currentLoad(0), dynamicWeight(0.0), trafficDirty(false) {}
     
-    Edge(int destID, double w) : destinationID(destID), weight(w),
-             capacity(DEFAULT_ROAD_CAPACITY), currentLoad(0), dynamicWeight(w) {}
+    Edge(int destID, double w) : destinationID(destID), weight(w), id(-1), reverseID(-1),
+             capacity(DEFAULT_ROAD_CAPACITY), currentLoad(0), dynamicWeight(w), trafficDirty(false) {}
     
-    Edge(int destID, double w, int cap) : destinationID(destID), weight(w),
-             capacity(cap), currentLoad(0), dynamicWeight(w) {}
+    Edge(int destID, double w, int cap) : destinationID(destID), weight(w), id(-1), reverseID(-1),
+             capacity(cap), currentLoad(0), dynamicWeight(w), trafficDirty(false) {}
 
     // Calculate congestion factor (0.0 = empty, 1.0 = full)
     double getCongestionFactor() const {
@@ -381,12 +548,17 @@ struct Edge {
         return (double)currentLoad / (double)capacity;
     }
 
-    // Update dynamic weight based on current traffic
-    // Formula: dynamicWeight = length * (1 + (load/capacity)^2)
+    // Formula: length * (1 + (load/capacity)^2)
     // This makes congested roads exponentially "longer" to pathfinding
+    static double getCongestedWeight(double length, double load, int capacity) {
+        if (capacity <= 0) return length;
+        double congestion = load / (double)capacity;
+        return length * (1.0 + congestion * congestion);
+    }
+
+    // Update dynamic weight based on current traffic
     void updateDynamicWeight() {
-        double congestion = getCongestionFactor();
-        dynamicWeight = weight * (1.0 + congestion * congestion);
+        dynamicWeight = getCongestedWeight(weight, (double)currentLoad, capacity);
     }
 
     // Check if road is at capacity
@@ -401,6 +573,150 @@ struct Edge {
 };
 
 
+// ROAD ADJACENCY (CSR SNAPSHOT)
+// Contiguous mirror of every CityNode::roads list so searches never chase list pointers.
+// Row u lives in slots [rowStart[u], rowStart[u] + rowDegree[u]) of the packed arrays.
+// Each row keeps spare slots so addRoad/removeRoad patch it in place; a full row is
+// moved to the end of the arrays and the hole is reclaimed by compact().
+constexpr int CSR_MIN_ROW_CAPACITY = 4;
+
+struct RoadCSR {
+    Vector<int> rowStart;
+    Vector<int> rowDegree;
+    Vector<int> rowCapacity;
+
+    Vector<int> targets;            // Edge::destinationID
+    Vector<double> weights;         // Edge::weight
+    Vector<double> dynamicWeights;  // Edge::dynamicWeight (refreshed by updateTrafficWeights)
+    Vector<Edge*> edges;            // Back-pointer to the authoritative Edge in CityNode::roads
+    Vector<int> edgeSlots;          // Edge::id -> slot (-1 once the road is removed)
+
+    int wastedSlots = 0;
+
+    int getNodeCount() const { return rowStart.getSize(); }
+    int getSlotCount() const { return targets.getSize(); }
+
+    int slotOf(int edgeID) const {
+        if (edgeID < 0 || edgeID >= edgeSlots.getSize()) return -1;
+        return edgeSlots[edgeID];
+    }
+
+    void clear() {
+        rowStart.clear();
+        rowDegree.clear();
+        rowCapacity.clear();
+        targets.clear();
+        weights.clear();
+        dynamicWeights.clear();
+        edges.clear();
+        edgeSlots.clear();
+        wastedSlots = 0;
+    }
+
+    // Reserve a new empty row at the end of the arrays
+    void addNode(int capacity = CSR_MIN_ROW_CAPACITY) {
+        rowStart.push_back(targets.getSize());
+        rowDegree.push_back(0);
+        rowCapacity.push_back(capacity);
+        appendSlots(capacity);
+    }
+
+    void insert(int u, Edge* edge) {
+        if (rowDegree[u] == rowCapacity[u]) {
+            relocateRow(u, rowCapacity[u] * 2);
+        }
+        int slot = rowStart[u] + rowDegree[u];
+        targets[slot] = edge->destinationID;
+        weights[slot] = edge->weight;
+        dynamicWeights[slot] = edge->dynamicWeight;
+        edges[slot] = edge;
+        rowDegree[u]++;
+
+        if (edge->id >= 0) {
+            while (edgeSlots.getSize() <= edge->id) edgeSlots.push_back(-1);
+            edgeSlots[edge->id] = slot;
+        }
+    }
+
+    // Removes the u->v slot, shifting the rest of the row to keep list order
+    void remove(int u, int v) {
+        int slot = find(u, v);
+        if (slot == -1) return;
+        int last = rowStart[u] + rowDegree[u] - 1;
+        setSlot(edges[slot], -1);
+        for (int k = slot; k < last; k++) {
+            targets[k] = targets[k + 1];
+            weights[k] = weights[k + 1];
+            dynamicWeights[k] = dynamicWeights[k + 1];
+            edges[k] = edges[k + 1];
+            setSlot(edges[k], k);
+        }
+        rowDegree[u]--;
+    }
+
+    int find(int u, int v) const {
+        int begin = rowStart[u];
+        int end = begin + rowDegree[u];
+        const int* tgt = targets.begin();
+        for (int k = begin; k < end; k++) {
+            if (tgt[k] == v) return k;
+        }
+        return -1;
+    }
+
+    bool needsCompaction() const {
+        return wastedSlots > 64 && wastedSlots * 2 > targets.getSize();
+    }
+
+    // Rewrites all rows back-to-back, dropping the holes left by relocateRow
+    void compact() {
+        RoadCSR packed;
+        packed.edgeSlots.resize(edgeSlots.getSize(), -1);
+        int n = rowStart.getSize();
+        for (int u = 0; u < n; u++) {
+            int cap = rowDegree[u] + CSR_MIN_ROW_CAPACITY / 2;
+            if (cap < CSR_MIN_ROW_CAPACITY) cap = CSR_MIN_ROW_CAPACITY;
+            packed.addNode(cap);
+            int from = rowStart[u];
+            for (int k = 0; k < rowDegree[u]; k++) {
+                packed.insert(u, edges[from + k]);
+            }
+        }
+        *this = packed;
+    }
+
+private:
+    void setSlot(const Edge* edge, int slot) {
+        if (edge->id >= 0 && edge->id < edgeSlots.getSize()) edgeSlots[edge->id] = slot;
+    }
+
+    void appendSlots(int count) {
+        for (int i = 0; i < count; i++) {
+            targets.push_back(-1);
+            weights.push_back(0.0);
+            dynamicWeights.push_back(0.0);
+            edges.push_back(nullptr);
+        }
+    }
+
+    void relocateRow(int u, int newCapacity) {
+        int oldStart = rowStart[u];
+        int newStart = targets.getSize();
+        appendSlots(newCapacity);
+        for (int k = 0; k < rowDegree[u]; k++) {
+            targets[newStart + k] = targets[oldStart + k];
+            weights[newStart + k] = weights[oldStart + k];
+            dynamicWeights[newStart + k] = dynamicWeights[oldStart + k];
+            edges[newStart + k] = edges[oldStart + k];
+            setSlot(edges[newStart + k], newStart + k);
+        }
+        wastedSlots += rowCapacity[u];
+        rowStart[u] = newStart;
+        rowCapacity[u] = newCapacity;
+    }
+};
+
+
 struct CityNode {
     int id;
     string databaseID;
@@ -410,6 +726,9 @@ struct CityNode {
     string type;
     double lat, lon;
 
+    int typeID;         // FacilityType::intern(type)
+    int sectorID;       // SECTOR_GRID index of sector (-1 = "Unknown")
+
     string operatingHours;
     bool isAccessible;
     string additionalInfo;
@@ -418,15 +737,16 @@ struct CityNode {
 
     CityNode(int i, string dbID, string sID, string n, string t, double lt, double ln)
         : id(i), databaseID(dbID), stopID(sID), name(n), type(t), lat(lt), lon(ln),
+        typeID(FacilityType::intern(t)), sectorID(GeometryUtils::resolveSectorIndex(lt, ln)),
         operatingHours(""), isAccessible(true), additionalInfo("") {
-        sector = GeometryUtils::resolveSector(lt, ln);
+        sector = (sectorID != -1) ? SECTOR_GRID[sectorID].name : "Unknown";
     }
 
     int getConnectionCount() const { return roads.size(); }
     const LinkedList<Edge>& getRoads() const { return roads; }
 
-    bool canBeTransportStop() const { return FacilityType::isTransportStop(type); }
-    bool isPublicFacility() const { return FacilityType::isPublicFacility(type); }
+    bool canBeTransportStop() const { return FacilityType::isTransportStop(typeID); }
+    bool isPublicFacility() const { return FacilityType::isPublicFacility(typeID); }
 };
 
 
@@ -442,6 +762,164 @@ struct DijkstraNode {
     }
 };
 
+// Queue index of a DijkstraNode (see IndexedPriorityQueue)
+struct DijkstraNodeIndex {
+    static int index(const DijkstraNode& node) { return node.nodeID; }
+};
+
+
+// SEARCH WORKSPACE
+// Scratch state for one Dijkstra-style search, reused across calls.
+// Every slot remembers the generation it was written in, so begin() forgets the previous
+// search by bumping a counter instead of re-filling the arrays; the heap keeps its storage.
+// The heap holds one entry per node: pushing a node that is already queued lowers its key
+// instead of adding a duplicate, so the heap never outgrows the search frontier.
+struct SearchWorkspace {
+    Vector<double> distance;
+    Vector<int> parent;
+    Vector<int> parentArc;              // Search-specific tag for the edge into a node (-1 if unused)
+    Vector<unsigned int> reachedStamp;  // distance/parent/parentArc are valid for this generation
+    Vector<unsigned int> settledStamp;
+    unsigned int generation;
+    IndexedPriorityQueue<DijkstraNode, DijkstraNodeIndex> heap;
+
+    SearchWorkspace() : generation(0) {
+        heap.setAutoShrink(false);
+    }
+
+    // Starts a new search over nodes [0, nodeCount)
+    void begin(int nodeCount) {
+        if (reachedStamp.getSize() < nodeCount) {
+            distance.resize(nodeCount, INF);
+            parent.resize(nodeCount, -1);
+            parentArc.resize(nodeCount, -1);
+            reachedStamp.resize(nodeCount, 0);
+            settledStamp.resize(nodeCount, 0);
+            heap.reserveIndices(nodeCount);
+        }
+        generation++;
+        if (generation == 0) {
+            // Counter wrapped: stale stamps could collide with new generations
+            for (int i = 0; i < reachedStamp.getSize(); i++) {
+                reachedStamp[i] = 0;
+                settledStamp[i] = 0;
+            }
+            generation = 1;
+        }
+        heap.clear();
+    }
+
+    bool isReached(int v) const { return reachedStamp[v] == generation; }
+    bool isSettled(int v) const { return settledStamp[v] == generation; }
+    double getDistance(int v) const { return isReached(v) ? distance[v] : INF; }
+    int getParent(int v) const { return isReached(v) ? parent[v] : -1; }
+    int getParentArc(int v) const { return isReached(v) ? parentArc[v] : -1; }
+
+    void setDistance(int v, double dist, int from, int arc = -1) {
+        distance[v] = dist;
+        parent[v] = from;
+        parentArc[v] = arc;
+        reachedStamp[v] = generation;
+    }
+
+    void settle(int v) { settledStamp[v] = generation; }
+
+    // Node sequence from the search root to v (empty if v was not reached)
+    Vector<int> tracePath(int v) const {
+        Vector<int> path;
+        if (!isReached(v)) return path;
+        for (int current = v; current != -1; current = parent[current]) {
+            path.push_back(current);
+        }
+        for (int i = 0; i < path.getSize() / 2; i++) {
+            int temp = path[i];
+            path[i] = path[path.getSize() - 1 - i];
+            path[path.getSize() - 1 - i] = temp;
+        }
+        return path;
+    }
+};
+
+
+// Point-to-point search strategy for findShortestPath / findShortestPathDynamic.
+// All modes return an optimal path; they only differ in how much of the graph they settle.
+enum class RouteSearchMode {
+    DEFAULT,        // Use the graph-wide mode (CityGraph::setDefaultSearchMode)
+    DIJKSTRA,       // Plain unidirectional Dijkstra
+    ASTAR,          // Dijkstra guided by a straight-line lower bound to the target
+    BIDIRECTIONAL,  // Forward search from start and backward search from end, meeting in the middle
+    HIERARCHY,      // Contraction hierarchy query (static weights only; dynamic queries use A*)
+    SECTOR_OVERLAY  // Full resolution only in the start/end sectors, boundary-node overlay in between
+};
+
+
+// Route cache counters (see CityGraph::getRouteCacheStats)
+struct RouteCacheStats {
+    long long hits;
+    long long misses;
+    int entries;
+    int capacity;
+
+    RouteCacheStats() : hits(0), misses(0), entries(0), capacity(0) {}
+
+    double getHitRate() const {
+        long long total = hits + misses;
+        return (total > 0) ? (double)hits / (double)total : 0.0;
+    }
+};
+
+
+// One origin-destination entry of a trip table (trips = vehicles, as in Edge::currentLoad)
+struct TripDemand {
+    int originID;
+    int destinationID;
+    double trips;
+
+    TripDemand() : originID(-1), destinationID(-1), trips(0.0) {}
+    TripDemand(int from, int to, double count = 1.0) : originID(from), destinationID(to), trips(count) {}
+};
+
+
+// Frank-Wolfe stops after this many all-or-nothing rounds or once the relative gap
+// (share of travel cost above the shortest-path cost) drops below the tolerance
+constexpr int TRAFFIC_ASSIGNMENT_MAX_ITERATIONS = 50;
+constexpr double TRAFFIC_ASSIGNMENT_GAP = 1e-4;
+
+// Equilibrium from CityGraph::assignTraffic
+struct TrafficAssignmentResult {
+    Vector<double> edgeLoad;    // Edge ID -> vehicles on the road (both directions, like currentLoad)
+    Vector<double> edgeWeight;  // Edge ID -> congested weight at that load
+    int iterations;
+    double relativeGap;
+    double totalTravelCost;     // Sum over all trips of their congested route weight
+    double assignedTrips;
+    double unroutedTrips;       // Invalid node IDs or no road connection
+    double elapsedMs;
+
+    TrafficAssignmentResult()
+        : iterations(0), relativeGap(0.0), totalTravelCost(0.0), assignedTrips(0.0),
+        unroutedTrips(0.0), elapsedMs(0.0) {}
+};
+
+
+// Alternative routes (CityGraph::findAlternativeRoutes): each route found makes its roads
+// ALTERNATIVE_ROUTE_PENALTY times more expensive for the next search. A candidate is kept if
+// it costs at most maxStretch times the shortest route and drives at most maxOverlap of its
+// weight on the roads of any route kept before it.
+constexpr int ALTERNATIVE_ROUTE_COUNT = 3;
+constexpr double ALTERNATIVE_ROUTE_MAX_STRETCH = 1.3;
+constexpr double ALTERNATIVE_ROUTE_MAX_OVERLAP = 0.7;
+constexpr double ALTERNATIVE_ROUTE_PENALTY = 1.5;
+constexpr int ALTERNATIVE_ROUTE_SEARCHES = 3;   // Penalized searches allowed per route asked for
+
+struct AlternativeRoute {
+    Vector<int> path;
+    double distance;    // Unpenalized weight on the searched metric
+    double overlap;     // Largest share of distance on the roads of an earlier route (0 for the first)
+
+    AlternativeRoute() : distance(0.0), overlap(0.0) {}
+};
+
 
 struct TravelRecord {
     string citizenCNIC;
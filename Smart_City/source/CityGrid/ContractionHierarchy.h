@@ -0,0 +1,417 @@
+#pragma once
+#include "CityUtils.h"
+
+// ==================== CONTRACTION HIERARCHY ====================
+// Preprocessed index for exact shortest paths on the static Edge::weight metric.
+// Nodes are contracted from least to most important; each contraction inserts shortcut
+// arcs so that every shortest path can be found by only ever moving "upward" (towards
+// more important nodes) from both ends. Roads are added in equal-weight pairs, so one
+// upward graph serves both the forward search from the start and the backward search
+// from the end.
+
+// Contraction order tuning
+constexpr double CH_IMPORTANCE_WEIGHT = 1.0;   // Priority added per level of the importance hint
+constexpr int CH_WITNESS_SETTLE_LIMIT = 200;   // Witness searches give up (and keep the shortcut) after this
+
+class ContractionHierarchy {
+public:
+    struct Arc {
+        int target;
+        double weight;
+        int middle;     // Contracted node this shortcut bypasses (-1 for an original road)
+
+        Arc() : target(-1), weight(INF), middle(-1) {}
+        Arc(int t, double w, int m) : target(t), weight(w), middle(m) {}
+    };
+
+    // Upward search spaces of a set of targets, grouped by the node they reached
+    struct TargetBuckets {
+        Vector<int> start;          // Node v's entries are [start[v], start[v + 1])
+        Vector<int> column;         // Index into the targets list
+        Vector<double> distance;    // Upward distance between v and that target
+    };
+
+private:
+    int nodeCount;
+    int shortcutCount;
+    bool built;
+
+    Vector<int> rank;               // Contraction order (higher = more important)
+    Vector<Vector<Arc>> upward;     // upward[v]: arcs from v to higher-ranked nodes
+
+    // Preprocessing helpers
+    static void addOrImprove(Vector<Arc>& arcs, int target, double weight, int middle);
+    static void removeArc(Vector<Arc>& arcs, int target);
+    int contractNode(int v, Vector<Vector<Arc>>& adjacency, bool apply, SearchWorkspace& witness);
+
+    // Query helpers
+    const Arc* findUpwardArc(int from, int to) const;
+    void appendArc(int from, int to, int middle, Vector<int>& path) const;
+
+    // Settles every node reachable upward from 'from', calling visit(node, distance) on each
+    template <typename Visit>
+    void climb(int from, SearchWorkspace& ws, Visit visit) const;
+
+public:
+    ContractionHierarchy();
+
+    // importance[v] is an ordering hint: higher values are contracted later
+    void build(const RoadCSR& csr, int count, const Vector<int>& importance, SearchWorkspace& witness);
+
+    // Marks the hierarchy stale; cheap enough to call on every road change
+    void clear() { built = false; }
+
+    bool isBuilt() const { return built; }
+    int getShortcutCount() const { return shortcutCount; }
+
+    // Upward searches from both ends; each side's parentArc holds the arc's middle node
+    Vector<int> findShortestPath(int startID, int endID, double& totalDistance,
+        SearchWorkspace& forward, SearchWorkspace& backward);
+
+    // Many-to-many distances (bucket method): collectBuckets records the upward search space
+    // of every target once, then each scanBuckets call is a single upward search from a source
+    // that meets all targets at once. Both are read-only, so sources can be scanned in parallel.
+    void collectBuckets(const Vector<int>& targets, TargetBuckets& buckets, SearchWorkspace& ws) const;
+    // row[j] = distance from source to targets[j] (row must hold one INF-filled slot per target)
+    void scanBuckets(int source, const TargetBuckets& buckets, double* row, SearchWorkspace& ws) const;
+};
+
+
+
+// ==================== CONSTRUCTOR ====================
+
+inline ContractionHierarchy::ContractionHierarchy() : nodeCount(0), shortcutCount(0), built(false) {}
+
+// ==================== PREPROCESSING ====================
+
+inline void ContractionHierarchy::addOrImprove(Vector<Arc>& arcs, int target, double weight, int middle) {
+    for (int i = 0; i < arcs.getSize(); i++) {
+        if (arcs[i].target == target) {
+            if (weight < arcs[i].weight) {
+                arcs[i].weight = weight;
+                arcs[i].middle = middle;
+            }
+            return;
+        }
+    }
+    arcs.push_back(Arc(target, weight, middle));
+}
+
+inline void ContractionHierarchy::removeArc(Vector<Arc>& arcs, int target) {
+    for (int i = 0; i < arcs.getSize(); i++) {
+        if (arcs[i].target == target) {
+            arcs[i] = arcs[arcs.getSize() - 1];
+            arcs.pop_back();
+            return;
+        }
+    }
+}
+
+// Finds the shortcuts needed to bypass v: for every pair of remaining neighbours (u, w),
+// a local "witness" search from u that avoids v decides whether u-v-w is still the only
+// shortest connection. With apply=false only the shortcuts are counted (for ordering).
+inline int ContractionHierarchy::contractNode(int v, Vector<Vector<Arc>>& adjacency, bool apply,
+    SearchWorkspace& witness) {
+    Vector<Arc> neighbours = adjacency[v];
+    int degree = neighbours.getSize();
+    int needed = 0;
+
+    for (int i = 0; i < degree; i++) {
+        int u = neighbours[i].target;
+        double toU = neighbours[i].weight;
+
+        if (i + 1 >= degree) break;
+        double limit = 0.0;
+        for (int j = i + 1; j < degree; j++) {
+            if (toU + neighbours[j].weight > limit) limit = toU + neighbours[j].weight;
+        }
+
+        // Bounded Dijkstra from u that never passes through v
+        witness.begin(nodeCount);
+        witness.setDistance(u, 0.0, -1);
+        witness.heap.push(DijkstraNode(u, 0.0));
+        int settled = 0;
+
+        while (!witness.heap.empty() && settled < CH_WITNESS_SETTLE_LIMIT) {
+            DijkstraNode current = witness.heap.top();
+            witness.heap.pop();
+
+            int x = current.nodeID;
+            if (witness.isSettled(x)) continue;
+            if (current.distance > limit) break;
+            witness.settle(x);
+            settled++;
+
+            const Vector<Arc>& arcs = adjacency[x];
+            for (int k = 0; k < arcs.getSize(); k++) {
+                int y = arcs[k].target;
+                if (y == v) continue;
+                double candidate = current.distance + arcs[k].weight;
+                if (candidate < witness.getDistance(y)) {
+                    witness.setDistance(y, candidate, x);
+                    witness.heap.push(DijkstraNode(y, candidate));
+                }
+            }
+        }
+
+        for (int j = i + 1; j < degree; j++) {
+            int w = neighbours[j].target;
+            double viaV = toU + neighbours[j].weight;
+            if (witness.getDistance(w) > viaV) {
+                needed++;
+                if (apply) {
+                    addOrImprove(adjacency[u], w, viaV, v);
+                    addOrImprove(adjacency[w], u, viaV, v);
+                }
+            }
+        }
+    }
+
+    return needed;
+}
+
+inline void ContractionHierarchy::build(const RoadCSR& csr, int count, const Vector<int>& importance,
+    SearchWorkspace& witness) {
+    nodeCount = count;
+    shortcutCount = 0;
+
+    rank = Vector<int>();
+    rank.resize(nodeCount, -1);
+    upward = Vector<Vector<Arc>>();
+    upward.resize(nodeCount);
+
+    // Working copy of the road graph; contracted nodes are unlinked from it as we go
+    Vector<Vector<Arc>> adjacency;
+    adjacency.resize(nodeCount);
+    for (int u = 0; u < nodeCount; u++) {
+        int end = csr.rowStart[u] + csr.rowDegree[u];
+        for (int k = csr.rowStart[u]; k < end; k++) {
+            if (csr.targets[k] != u) addOrImprove(adjacency[u], csr.targets[k], csr.weights[k], -1);
+        }
+    }
+
+    Vector<int> deletedNeighbours;
+    deletedNeighbours.resize(nodeCount, 0);
+
+    // Priority = edge difference + contracted neighbours + importance hint (lowest goes first)
+    PriorityQueue<DijkstraNode> order;
+    for (int v = 0; v < nodeCount; v++) {
+        int shortcuts = contractNode(v, adjacency, false, witness);
+        double priority = shortcuts - adjacency[v].getSize() + CH_IMPORTANCE_WEIGHT * importance[v];
+        order.push(DijkstraNode(v, priority));
+    }
+
+    int nextRank = 0;
+    while (!order.empty()) {
+        DijkstraNode current = order.top();
+        order.pop();
+
+        int v = current.nodeID;
+        if (rank[v] != -1) continue;
+
+        // Lazy update: re-evaluate and requeue if v is no longer the cheapest choice
+        int shortcuts = contractNode(v, adjacency, false, witness);
+        double priority = shortcuts - adjacency[v].getSize() + deletedNeighbours[v]
+            + CH_IMPORTANCE_WEIGHT * importance[v];
+        if (!order.empty() && priority > order.top().distance) {
+            order.push(DijkstraNode(v, priority));
+            continue;
+        }
+
+        upward[v] = adjacency[v];
+        shortcutCount += contractNode(v, adjacency, true, witness);
+
+        // Re-read the neighbours: shortcuts never touch v's own list
+        const Vector<Arc>& arcs = adjacency[v];
+        for (int k = 0; k < arcs.getSize(); k++) {
+            removeArc(adjacency[arcs[k].target], v);
+            deletedNeighbours[arcs[k].target]++;
+        }
+        adjacency[v].clear();
+        rank[v] = nextRank++;
+    }
+
+    built = true;
+}
+
+// ==================== QUERY ====================
+
+inline const ContractionHierarchy::Arc* ContractionHierarchy::findUpwardArc(int from, int to) const {
+    const Vector<Arc>& arcs = upward[from];
+    for (int i = 0; i < arcs.getSize(); i++) {
+        if (arcs[i].target == to) return &arcs[i];
+    }
+    return nullptr;
+}
+
+// Appends the road-level nodes of arc from->to (excluding from) to the path.
+// A shortcut over m was created while contracting m, so both halves live in upward[m].
+inline void ContractionHierarchy::appendArc(int from, int to, int middle, Vector<int>& path) const {
+    if (middle == -1) {
+        path.push_back(to);
+        return;
+    }
+    appendArc(from, middle, findUpwardArc(middle, from)->middle, path);
+    appendArc(middle, to, findUpwardArc(middle, to)->middle, path);
+}
+
+inline Vector<int> ContractionHierarchy::findShortestPath(int startID, int endID, double& totalDistance,
+    SearchWorkspace& forward, SearchWorkspace& backward) {
+    Vector<int> path;
+    totalDistance = 0.0;
+
+    if (!built || startID < 0 || startID >= nodeCount || endID < 0 || endID >= nodeCount) {
+        return path;
+    }
+    if (startID == endID) {
+        path.push_back(startID);
+        return path;
+    }
+
+    // Side 0 climbs from startID, side 1 from endID
+    SearchWorkspace* ws[2] = { &forward, &backward };
+    forward.begin(nodeCount);
+    backward.begin(nodeCount);
+    forward.setDistance(startID, 0.0, -1);
+    backward.setDistance(endID, 0.0, -1);
+    forward.heap.push(DijkstraNode(startID, 0.0));
+    backward.heap.push(DijkstraNode(endID, 0.0));
+
+    double best = INF;
+    int meetNode = -1;
+
+    while (true) {
+        // A side is finished once its cheapest open node cannot improve the best meeting
+        for (int side = 0; side < 2; side++) {
+            if (!ws[side]->heap.empty() && ws[side]->heap.top().distance >= best) ws[side]->heap.clear();
+        }
+        if (forward.heap.empty() && backward.heap.empty()) break;
+
+        int side;
+        if (forward.heap.empty()) side = 1;
+        else if (backward.heap.empty()) side = 0;
+        else side = (forward.heap.top().distance <= backward.heap.top().distance) ? 0 : 1;
+
+        SearchWorkspace& own = *ws[side];
+        DijkstraNode current = own.heap.top();
+        own.heap.pop();
+
+        int u = current.nodeID;
+        if (own.isSettled(u)) continue;
+        own.settle(u);
+
+        double through = forward.getDistance(u) + backward.getDistance(u);
+        if (through < best) {
+            best = through;
+            meetNode = u;
+        }
+
+        const Vector<Arc>& arcs = upward[u];
+        for (int k = 0; k < arcs.getSize(); k++) {
+            int v = arcs[k].target;
+            double candidate = current.distance + arcs[k].weight;
+            if (candidate < own.getDistance(v)) {
+                own.setDistance(v, candidate, u, arcs[k].middle);
+                own.heap.push(DijkstraNode(v, candidate));
+            }
+        }
+    }
+
+    if (meetNode == -1) return path;
+
+    // Up-path from startID to the meeting node, then expand every arc into roads
+    Vector<int> climb = forward.tracePath(meetNode);
+    path.push_back(startID);
+    for (int i = 0; i + 1 < climb.getSize(); i++) {
+        appendArc(climb[i], climb[i + 1], forward.getParentArc(climb[i + 1]), path);
+    }
+
+    // Down-path from the meeting node to endID
+    for (int current = meetNode; backward.getParent(current) != -1; current = backward.getParent(current)) {
+        appendArc(current, backward.getParent(current), backward.getParentArc(current), path);
+    }
+
+    totalDistance = best;
+    return path;
+}
+
+// ==================== MANY-TO-MANY ====================
+
+template <typename Visit>
+inline void ContractionHierarchy::climb(int from, SearchWorkspace& ws, Visit visit) const {
+    ws.begin(nodeCount);
+    ws.setDistance(from, 0.0, -1);
+    ws.heap.push(DijkstraNode(from, 0.0));
+
+    while (!ws.heap.empty()) {
+        DijkstraNode current = ws.heap.top();
+        ws.heap.pop();
+
+        int u = current.nodeID;
+        if (ws.isSettled(u)) continue;
+        ws.settle(u);
+        visit(u, current.distance);
+
+        const Vector<Arc>& arcs = upward[u];
+        for (int k = 0; k < arcs.getSize(); k++) {
+            int v = arcs[k].target;
+            double candidate = current.distance + arcs[k].weight;
+            if (candidate < ws.getDistance(v)) {
+                ws.setDistance(v, candidate, u);
+                ws.heap.push(DijkstraNode(v, candidate));
+            }
+        }
+    }
+}
+
+inline void ContractionHierarchy::collectBuckets(const Vector<int>& targets, TargetBuckets& buckets,
+    SearchWorkspace& ws) const {
+    // Gather (node, column, distance) triples, then counting-sort them by node
+    Vector<int> reachedNode;
+    Vector<int> reachedColumn;
+    Vector<double> reachedDistance;
+    for (int j = 0; j < targets.getSize(); j++) {
+        int t = targets[j];
+        if (!built || t < 0 || t >= nodeCount) continue;
+        climb(t, ws, [&](int v, double distance) {
+            reachedNode.push_back(v);
+            reachedColumn.push_back(j);
+            reachedDistance.push_back(distance);
+        });
+    }
+
+    buckets.start = Vector<int>();
+    buckets.start.resize(nodeCount + 1, 0);
+    for (int i = 0; i < reachedNode.getSize(); i++) {
+        buckets.start[reachedNode[i] + 1]++;
+    }
+    for (int v = 0; v < nodeCount; v++) {
+        buckets.start[v + 1] += buckets.start[v];
+    }
+
+    Vector<int> fill;
+    fill.resize(nodeCount, 0);
+    buckets.column = Vector<int>();
+    buckets.column.resize(reachedNode.getSize(), -1);
+    buckets.distance = Vector<double>();
+    buckets.distance.resize(reachedNode.getSize(), INF);
+    for (int i = 0; i < reachedNode.getSize(); i++) {
+        int v = reachedNode[i];
+        int slot = buckets.start[v] + fill[v]++;
+        buckets.column[slot] = reachedColumn[i];
+        buckets.distance[slot] = reachedDistance[i];
+    }
+}
+
+inline void ContractionHierarchy::scanBuckets(int source, const TargetBuckets& buckets, double* row,
+    SearchWorkspace& ws) const {
+    if (!built || source < 0 || source >= nodeCount || buckets.start.getSize() != nodeCount + 1) return;
+
+    // Every shortest path peaks at some node: the source climbs to it, the target climbs to it
+    climb(source, ws, [&](int v, double distance) {
+        for (int k = buckets.start[v]; k < buckets.start[v + 1]; k++) {
+            double through = distance + buckets.distance[k];
+            if (through < row[buckets.column[k]]) row[buckets.column[k]] = through;
+        }
+    });
+}
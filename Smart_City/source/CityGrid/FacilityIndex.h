@@ -0,0 +1,346 @@
+#pragma once
+#include "CityUtils.h"
+
+// ==================== NEAREST FACILITY INDEX ====================
+// Network Voronoi labels on the static Edge::weight metric: for each indexed facility type,
+// every node keeps its FACILITY_INDEX_K nearest facilities of that type (sorted by distance),
+// found by one multi-source Dijkstra. Lookups read the labels directly.
+// The labels are repaired in place as the graph changes:
+//  - a new facility node or road can only shorten distances, so the improvement is pushed
+//    outwards from where it happened;
+//  - a removed road invalidates every label whose shortest-path tree used it, and those
+//    labels are re-seeded from their neighbours and propagated again.
+// Keeping K labels lets a facility node skip itself and backs k-nearest queries.
+// Types are identified by their interned FacilityType ID.
+
+constexpr int FACILITY_INDEX_K = 6;
+
+class NearestFacilityIndex {
+private:
+    // Labels of one facility type; node v owns slots [v*K, v*K + K), source -1 marks an empty slot
+    struct TypeLabels {
+        int type;               // FacilityType ID
+        Vector<int> source;
+        Vector<double> distance;
+        Vector<int> parent;     // Neighbour the label arrived from (-1 for the facility itself)
+    };
+
+    struct LabelEntry {
+        int nodeID;
+        int source;
+        double distance;
+
+        LabelEntry() : nodeID(-1), source(-1), distance(INF) {}
+        LabelEntry(int n, int s, double d) : nodeID(n), source(s), distance(d) {}
+
+        bool operator<(const LabelEntry& other) const {
+            return distance < other.distance; // Min-heap
+        }
+    };
+
+    Vector<TypeLabels*> types;
+    int nodeCount;
+
+    TypeLabels* findType(int type) const;
+    void growTo(TypeLabels* labels, int count);
+
+    int findSlot(const TypeLabels* labels, int node, int src) const;
+    bool offer(TypeLabels* labels, int node, int src, double dist, int from);
+    void propagate(TypeLabels* labels, const RoadCSR& csr, PriorityQueue<LabelEntry>& pq);
+
+public:
+    NearestFacilityIndex() : nodeCount(0) {}
+    ~NearestFacilityIndex();
+
+    NearestFacilityIndex(const NearestFacilityIndex&) = delete;
+    NearestFacilityIndex& operator=(const NearestFacilityIndex&) = delete;
+
+    bool isBuilt(int type) const { return findType(type) != nullptr; }
+    void build(int type, const RoadCSR& csr, int count, const Vector<int>& sources);
+    void clear();
+
+    // Nearest facility other than fromNodeID (-1 if none is reachable)
+    int nearest(int type, int fromNodeID) const;
+
+    // Up to maxCount nearest facilities other than fromNodeID, closest first.
+    // maxCount must not exceed FACILITY_INDEX_K - 1.
+    Vector<int> kNearest(int type, int fromNodeID, int maxCount) const;
+
+    // Maintenance hooks (called by CityGraph after its CSR has been updated)
+    void onNodeAdded(int nodeID, int type);
+    void onRoadAdded(const RoadCSR& csr, int fromNode, int toNode, double weight);
+    void onRoadRemoved(const RoadCSR& csr, int id1, int id2);
+};
+
+
+
+// ==================== LIFETIME ====================
+
+inline NearestFacilityIndex::~NearestFacilityIndex() {
+    clear();
+}
+
+inline void NearestFacilityIndex::clear() {
+    for (int i = 0; i < types.getSize(); i++) {
+        delete types[i];
+    }
+    types.clear();
+}
+
+// ==================== LABEL HELPERS ====================
+
+inline NearestFacilityIndex::TypeLabels* NearestFacilityIndex::findType(int type) const {
+    for (int i = 0; i < types.getSize(); i++) {
+        if (types[i]->type == type) return types[i];
+    }
+    return nullptr;
+}
+
+inline void NearestFacilityIndex::growTo(TypeLabels* labels, int count) {
+    int slots = count * FACILITY_INDEX_K;
+    if (labels->source.getSize() >= slots) return;
+    if (slots > labels->source.getCapacity()) {
+        labels->source.reserve(slots * 2);
+        labels->distance.reserve(slots * 2);
+        labels->parent.reserve(slots * 2);
+    }
+    labels->source.resize(slots, -1);
+    labels->distance.resize(slots, INF);
+    labels->parent.resize(slots, -1);
+}
+
+inline int NearestFacilityIndex::findSlot(const TypeLabels* labels, int node, int src) const {
+    int base = node * FACILITY_INDEX_K;
+    for (int i = 0; i < FACILITY_INDEX_K; i++) {
+        if (labels->source[base + i] == src) return base + i;
+    }
+    return -1;
+}
+
+// Records dist as node's distance to facility src if it belongs in the node's K best.
+// Returns true if the labels changed (so the entry must be propagated further).
+inline bool NearestFacilityIndex::offer(TypeLabels* labels, int node, int src, double dist, int from) {
+    int base = node * FACILITY_INDEX_K;
+    int* source = labels->source.begin() + base;
+    double* distance = labels->distance.begin() + base;
+    int* parent = labels->parent.begin() + base;
+
+    int pos = -1;
+    for (int i = 0; i < FACILITY_INDEX_K; i++) {
+        if (source[i] == src) { pos = i; break; }
+    }
+
+    if (pos != -1) {
+        if (dist >= distance[pos]) return false;
+    }
+    else {
+        if (source[FACILITY_INDEX_K - 1] != -1 && dist >= distance[FACILITY_INDEX_K - 1]) return false;
+        pos = FACILITY_INDEX_K - 1;  // Evict the farthest (or fill the first empty) slot
+    }
+
+    // Slide the label towards the front to keep the slots sorted
+    while (pos > 0 && distance[pos - 1] > dist) {
+        source[pos] = source[pos - 1];
+        distance[pos] = distance[pos - 1];
+        parent[pos] = parent[pos - 1];
+        pos--;
+    }
+    source[pos] = src;
+    distance[pos] = dist;
+    parent[pos] = from;
+    return true;
+}
+
+inline void NearestFacilityIndex::propagate(TypeLabels* labels, const RoadCSR& csr, PriorityQueue<LabelEntry>& pq) {
+    const int* targets = csr.targets.begin();
+    const double* weights = csr.weights.begin();
+
+    while (!pq.empty()) {
+        LabelEntry current = pq.top();
+        pq.pop();
+
+        int u = current.nodeID;
+        int slot = findSlot(labels, u, current.source);
+        if (slot == -1 || labels->distance[slot] != current.distance) continue;  // Superseded
+
+        int end = csr.rowStart[u] + csr.rowDegree[u];
+        for (int k = csr.rowStart[u]; k < end; k++) {
+            int v = targets[k];
+            double candidate = current.distance + weights[k];
+            if (offer(labels, v, current.source, candidate, u)) {
+                pq.push(LabelEntry(v, current.source, candidate));
+            }
+        }
+    }
+}
+
+// ==================== BUILD / LOOKUP ====================
+
+inline void NearestFacilityIndex::build(int type, const RoadCSR& csr, int count, const Vector<int>& sources) {
+    if (count > nodeCount) nodeCount = count;
+
+    TypeLabels* labels = findType(type);
+    if (!labels) {
+        labels = new TypeLabels();
+        labels->type = type;
+        types.push_back(labels);
+    }
+    labels->source.clear();
+    labels->distance.clear();
+    labels->parent.clear();
+    growTo(labels, nodeCount);
+
+    PriorityQueue<LabelEntry> pq;
+    for (int i = 0; i < sources.getSize(); i++) {
+        if (offer(labels, sources[i], sources[i], 0.0, -1)) {
+            pq.push(LabelEntry(sources[i], sources[i], 0.0));
+        }
+    }
+    propagate(labels, csr, pq);
+}
+
+inline int NearestFacilityIndex::nearest(int type, int fromNodeID) const {
+    const TypeLabels* labels = findType(type);
+    if (!labels || fromNodeID < 0 || fromNodeID >= nodeCount) return -1;
+
+    int base = fromNodeID * FACILITY_INDEX_K;
+    for (int i = 0; i < FACILITY_INDEX_K; i++) {
+        int src = labels->source[base + i];
+        if (src == -1) break;
+        if (src != fromNodeID) return src;
+    }
+    return -1;
+}
+
+inline Vector<int> NearestFacilityIndex::kNearest(int type, int fromNodeID, int maxCount) const {
+    Vector<int> results;
+    const TypeLabels* labels = findType(type);
+    if (!labels || fromNodeID < 0 || fromNodeID >= nodeCount) return results;
+
+    int base = fromNodeID * FACILITY_INDEX_K;
+    for (int i = 0; i < FACILITY_INDEX_K && results.getSize() < maxCount; i++) {
+        int src = labels->source[base + i];
+        if (src == -1) break;
+        if (src != fromNodeID) results.push_back(src);
+    }
+    return results;
+}
+
+// ==================== INCREMENTAL REPAIR ====================
+
+inline void NearestFacilityIndex::onNodeAdded(int nodeID, int type) {
+    if (nodeID + 1 > nodeCount) nodeCount = nodeID + 1;
+
+    for (int t = 0; t < types.getSize(); t++) {
+        growTo(types[t], nodeCount);
+        // A new facility is its own nearest; its roads will carry the label outwards
+        if (types[t]->type == type) offer(types[t], nodeID, nodeID, 0.0, -1);
+    }
+}
+
+inline void NearestFacilityIndex::onRoadAdded(const RoadCSR& csr, int fromNode, int toNode, double weight) {
+    for (int t = 0; t < types.getSize(); t++) {
+        TypeLabels* labels = types[t];
+        PriorityQueue<LabelEntry> pq;
+
+        int base = fromNode * FACILITY_INDEX_K;
+        for (int i = 0; i < FACILITY_INDEX_K; i++) {
+            int src = labels->source[base + i];
+            if (src == -1) break;
+            double candidate = labels->distance[base + i] + weight;
+            if (offer(labels, toNode, src, candidate, fromNode)) {
+                pq.push(LabelEntry(toNode, src, candidate));
+            }
+        }
+        propagate(labels, csr, pq);
+    }
+}
+
+inline void NearestFacilityIndex::onRoadRemoved(const RoadCSR& csr, int id1, int id2) {
+    const int* targets = csr.targets.begin();
+    const double* weights = csr.weights.begin();
+
+    for (int t = 0; t < types.getSize(); t++) {
+        TypeLabels* labels = types[t];
+        int slots = nodeCount * FACILITY_INDEX_K;
+
+        // 1. Labels that arrived over the removed road, or whose parent no longer carries
+        //    their facility, can no longer be trusted
+        Vector<bool> invalid;
+        invalid.resize(slots, false);
+        Vector<int> stack;
+        for (int slot = 0; slot < slots; slot++) {
+            int src = labels->source[slot];
+            if (src == -1) continue;
+            int node = slot / FACILITY_INDEX_K;
+            int from = labels->parent[slot];
+
+            bool broken;
+            if (from == -1) broken = (node != src);
+            else broken = (node == id1 && from == id2) || (node == id2 && from == id1)
+                || findSlot(labels, from, src) == -1;
+
+            if (broken) {
+                invalid[slot] = true;
+                stack.push_back(slot);
+            }
+        }
+        if (stack.getSize() == 0) continue;
+
+        // 2. ...and so can everything downstream of them in the same facility's tree
+        for (int i = 0; i < stack.getSize(); i++) {
+            int node = stack[i] / FACILITY_INDEX_K;
+            int src = labels->source[stack[i]];
+            int end = csr.rowStart[node] + csr.rowDegree[node];
+            for (int k = csr.rowStart[node]; k < end; k++) {
+                int child = findSlot(labels, targets[k], src);
+                if (child != -1 && !invalid[child] && labels->parent[child] == node) {
+                    invalid[child] = true;
+                    stack.push_back(child);
+                }
+            }
+        }
+
+        // 3. Drop the invalid labels, keeping each node's remaining slots sorted
+        Vector<int> affected;
+        for (int node = 0; node < nodeCount; node++) {
+            int base = node * FACILITY_INDEX_K;
+            int write = base;
+            bool lost = false;
+            for (int i = 0; i < FACILITY_INDEX_K; i++) {
+                int slot = base + i;
+                if (invalid[slot]) { lost = true; continue; }
+                labels->source[write] = labels->source[slot];
+                labels->distance[write] = labels->distance[slot];
+                labels->parent[write] = labels->parent[slot];
+                write++;
+            }
+            for (; write < base + FACILITY_INDEX_K; write++) {
+                labels->source[write] = -1;
+                labels->distance[write] = INF;
+                labels->parent[write] = -1;
+            }
+            if (lost) affected.push_back(node);
+        }
+
+        // 4. Refill the affected nodes from their neighbours' surviving labels
+        PriorityQueue<LabelEntry> pq;
+        for (int i = 0; i < affected.getSize(); i++) {
+            int node = affected[i];
+            int end = csr.rowStart[node] + csr.rowDegree[node];
+            for (int k = csr.rowStart[node]; k < end; k++) {
+                int neighbour = targets[k];
+                int base = neighbour * FACILITY_INDEX_K;
+                for (int j = 0; j < FACILITY_INDEX_K; j++) {
+                    int src = labels->source[base + j];
+                    if (src == -1) break;
+                    double candidate = labels->distance[base + j] + weights[k];
+                    if (offer(labels, node, src, candidate, neighbour)) {
+                        pq.push(LabelEntry(node, src, candidate));
+                    }
+                }
+            }
+        }
+        propagate(labels, csr, pq);
+    }
+}
@@ -0,0 +1,433 @@
+#pragma once
+#include "CityUtils.h"
+
+// ==================== INCREMENTAL ROUTER ====================
+// Long-lived point-to-point routes on the dynamic metric, repaired in place as traffic moves
+// (D* Lite). Each route searches backwards from its goal, so g(v) is v's distance to the goal;
+// when a vehicle moves on, the search start follows it without invalidating anything.
+// A route watches every node it has given a finite g until it is reset or closed. When the
+// dynamic weight of road u->v changes, only the routes watching v recompute rhs(u) and queue u,
+// and the next path request re-expands just the nodes whose distance actually changed. Idle
+// routes cost nothing, so a traffic update costs time in proportion to the changed roads, not
+// to the size of the fleet.
+// Roads come in two-way pairs, so a node's predecessors are read from its own CSR row.
+// Road or node changes reset every route; they re-plan from scratch on their next request.
+
+constexpr int INCREMENTAL_QUEUE_SLACK = 4;   // Compact a route's queue past this many entries per node
+
+// D* Lite needs strictly positive road costs: two co-located nodes joined by a zero-length road
+// would otherwise keep vouching for each other's outdated distance after a road beyond them slows
+// down. Costs are read as at least this much; reported distances use the real weights.
+constexpr double INCREMENTAL_MIN_ROAD_COST = 1e-9;
+
+class IncrementalRouter {
+private:
+    struct QueueEntry {
+        int nodeID;
+        double k1;
+        double k2;
+        unsigned int version;   // Matches the node's queuedVersion while this entry is current
+
+        QueueEntry() : nodeID(-1), k1(INF), k2(INF), version(0) {}
+        QueueEntry(int n, double a, double b, unsigned int v) : nodeID(n), k1(a), k2(b), version(v) {}
+
+        bool operator<(const QueueEntry& other) const {
+            if (k1 != other.k1) return k1 < other.k1; // Min-heap on (k1, k2)
+            return k2 < other.k2;
+        }
+    };
+
+    // One registration of a route in watchers[node], at index slot of that list
+    struct WatchedNode {
+        int node;
+        int slot;
+
+        WatchedNode() : node(-1), slot(-1) {}
+        WatchedNode(int n, int s) : node(n), slot(s) {}
+    };
+
+    // The per-node arrays outlive close(): a reused handle refills them in place
+    struct Route {
+        bool active;
+        bool needsReset;
+        bool affected;              // Distances changed since the last path was handed out
+
+        int start;
+        int goal;
+        int last;                   // Start at the last key-offset update
+        double km;                  // Accumulated heuristic offset for the moving start
+
+        Vector<double> g;
+        Vector<double> rhs;
+        Vector<unsigned int> queuedVersion;
+        Vector<unsigned char> watched;
+        Vector<WatchedNode> watchedNodes;
+        PriorityQueue<QueueEntry> queue;
+
+        Route() : active(false), needsReset(true), affected(false),
+            start(-1), goal(-1), last(-1), km(0.0) {}
+    };
+
+    // A route watching a node, and where that node sits in the route's watchedNodes
+    struct Watch {
+        int handle;
+        int index;
+
+        Watch() : handle(-1), index(-1) {}
+        Watch(int h, int i) : handle(h), index(i) {}
+    };
+
+    const RoadCSR* csr;
+    const Vector<double>* nodeLat;
+    const Vector<double>* nodeLon;
+    const double* weightPerKm;
+
+    Vector<Route*> routes;
+    Vector<int> freeHandles;
+    Vector<Vector<Watch>> watchers;     // Node -> routes that hold a finite g for it
+
+    long long expansions;
+
+    static double cost(double weight) { return (weight < INCREMENTAL_MIN_ROAD_COST) ? INCREMENTAL_MIN_ROAD_COST : weight; }
+    double estimate(int from, int to) const;
+    void calcKey(const Route& route, int node, double& k1, double& k2) const;
+    void enqueue(Route& route, int node);
+    bool updateVertex(Route& route, int node);
+    void watch(int handle, Route& route, int node);
+    void unwatchAll(Route& route);
+    void reset(int handle, Route& route);
+    void compactQueue(Route& route);
+    void computeShortestPath(int handle, Route& route);
+    Route* getRoute(int handle) const;
+
+public:
+    IncrementalRouter() : csr(nullptr), nodeLat(nullptr), nodeLon(nullptr), weightPerKm(nullptr), expansions(0) {}
+    ~IncrementalRouter();
+
+    IncrementalRouter(const IncrementalRouter&) = delete;
+    IncrementalRouter& operator=(const IncrementalRouter&) = delete;
+
+    // Graph data the router reads on every call (the objects must outlive the router)
+    void attach(const RoadCSR* roads, const Vector<double>* lat, const Vector<double>* lon, const double* minWeightPerKm);
+
+    // Returns a route handle, or -1 if either node is invalid
+    int open(int startID, int goalID);
+    void close(int handle);
+    bool isOpen(int handle) const { return getRoute(handle) != nullptr; }
+    int getGoal(int handle) const;
+
+    // The route's owner has reached nodeID; the search start moves there
+    void moveStart(int handle, int nodeID);
+
+    // True if distances along the route changed since its path was last requested
+    bool isAffected(int handle) const;
+
+    // Current best path from the start to the goal (repaired first if needed); empty if unreachable
+    Vector<int> getPath(int handle, double& totalDistance);
+
+    // Maintenance hooks (called by CityGraph)
+    void onEdgeChanged(int fromNode, int toNode);
+    void invalidateAll();
+
+    int getOpenRouteCount() const { return routes.getSize() - freeHandles.getSize(); }
+    long long getExpansionCount() const { return expansions; }
+};
+
+
+
+// ==================== LIFETIME ====================
+
+inline IncrementalRouter::~IncrementalRouter() {
+    for (int i = 0; i < routes.getSize(); i++) {
+        delete routes[i];
+    }
+}
+
+inline void IncrementalRouter::attach(const RoadCSR* roads, const Vector<double>* lat,
+    const Vector<double>* lon, const double* minWeightPerKm) {
+    csr = roads;
+    nodeLat = lat;
+    nodeLon = lon;
+    weightPerKm = minWeightPerKm;
+}
+
+inline IncrementalRouter::Route* IncrementalRouter::getRoute(int handle) const {
+    if (handle < 0 || handle >= routes.getSize()) return nullptr;
+    Route* route = routes[handle];
+    return route->active ? route : nullptr;
+}
+
+inline int IncrementalRouter::open(int startID, int goalID) {
+    int nodeCount = csr ? csr->getNodeCount() : 0;
+    if (startID < 0 || startID >= nodeCount || goalID < 0 || goalID >= nodeCount) return -1;
+
+    int handle;
+    if (!freeHandles.empty()) {
+        handle = freeHandles[freeHandles.getSize() - 1];
+        freeHandles.pop_back();
+    }
+    else {
+        handle = routes.getSize();
+        routes.push_back(new Route());
+    }
+
+    Route* route = routes[handle];
+    route->active = true;
+    route->needsReset = true;
+    route->start = startID;
+    route->goal = goalID;
+    return handle;
+}
+
+inline void IncrementalRouter::close(int handle) {
+    Route* route = getRoute(handle);
+    if (!route) return;
+
+    route->active = false;
+    unwatchAll(*route);
+    route->queue.clear();
+    freeHandles.push_back(handle);
+}
+
+inline int IncrementalRouter::getGoal(int handle) const {
+    Route* route = getRoute(handle);
+    return route ? route->goal : -1;
+}
+
+inline bool IncrementalRouter::isAffected(int handle) const {
+    Route* route = getRoute(handle);
+    return route && (route->affected || route->needsReset);
+}
+
+// ==================== SEARCH HELPERS ====================
+
+inline double IncrementalRouter::estimate(int from, int to) const {
+    return GeometryUtils::getCostLowerBound((*nodeLat)[from], (*nodeLon)[from], (*nodeLat)[to], (*nodeLon)[to],
+        *weightPerKm);
+}
+
+inline void IncrementalRouter::calcKey(const Route& route, int node, double& k1, double& k2) const {
+    k2 = (route.g[node] < route.rhs[node]) ? route.g[node] : route.rhs[node];
+    k1 = (k2 >= INF) ? INF : k2 + estimate(route.start, node) + route.km;
+}
+
+// Queues node under its current key; older entries for it are skipped when they surface
+inline void IncrementalRouter::enqueue(Route& route, int node) {
+    double k1, k2;
+    calcKey(route, node, k1, k2);
+    route.queue.push(QueueEntry(node, k1, k2, ++route.queuedVersion[node]));
+}
+
+// rhs(node) = min over roads node->v of weight + g(v); requeues the node if it is inconsistent.
+// Returns true if rhs changed (otherwise the node's key and queue entry are still current).
+inline bool IncrementalRouter::updateVertex(Route& route, int node) {
+    if (node == route.goal) return false;
+
+    const int* targets = csr->targets.begin();
+    const double* weights = csr->dynamicWeights.begin();
+
+    double best = INF;
+    int end = csr->rowStart[node] + csr->rowDegree[node];
+    for (int k = csr->rowStart[node]; k < end; k++) {
+        double gv = route.g[targets[k]];
+        if (gv >= INF) continue;
+        double candidate = cost(weights[k]) + gv;
+        if (candidate < best) best = candidate;
+    }
+
+    if (best == route.rhs[node]) return false;
+    route.rhs[node] = best;
+    if (route.g[node] != route.rhs[node]) enqueue(route, node);
+    return true;
+}
+
+inline void IncrementalRouter::watch(int handle, Route& route, int node) {
+    if (route.watched[node]) return;
+    route.watched[node] = 1;
+    if (watchers.getSize() <= node) watchers.resize(csr->getNodeCount());
+    Vector<Watch>& list = watchers[node];
+    route.watchedNodes.push_back(WatchedNode(node, list.getSize()));
+    list.push_back(Watch(handle, route.watchedNodes.getSize() - 1));
+}
+
+// Takes every registration of the route out of the watcher lists: the last entry of a list
+// fills the hole, and its route is told the new slot
+inline void IncrementalRouter::unwatchAll(Route& route) {
+    for (int i = 0; i < route.watchedNodes.getSize(); i++) {
+        int node = route.watchedNodes[i].node;
+        route.watched[node] = 0;
+
+        Vector<Watch>& list = watchers[node];
+        int slot = route.watchedNodes[i].slot;
+        Watch moved = list[list.getSize() - 1];
+        list[slot] = moved;
+        routes[moved.handle]->watchedNodes[moved.index].slot = slot;
+        list.pop_back();
+    }
+    route.watchedNodes.clear();
+}
+
+inline void IncrementalRouter::reset(int handle, Route& route) {
+    int nodeCount = csr->getNodeCount();
+    unwatchAll(route);
+    route.needsReset = false;
+    route.affected = false;
+    route.km = 0.0;
+    route.last = route.start;
+
+    // Refilled in place: only a grown graph makes these allocate
+    route.g.clear();
+    route.g.resize(nodeCount, INF);
+    route.rhs.clear();
+    route.rhs.resize(nodeCount, INF);
+    route.queuedVersion.clear();
+    route.queuedVersion.resize(nodeCount, 0);
+    route.watched.resize(nodeCount, 0);     // Already all zero after unwatchAll
+    route.queue.clear();
+
+    route.rhs[route.goal] = 0.0;
+    enqueue(route, route.goal);
+    watch(handle, route, route.goal);
+}
+
+// Rebuilds the queue from the inconsistent nodes once stale entries dominate it
+inline void IncrementalRouter::compactQueue(Route& route) {
+    route.queue.clear();
+    for (int v = 0; v < route.g.getSize(); v++) {
+        if (route.g[v] != route.rhs[v]) enqueue(route, v);
+    }
+}
+
+inline void IncrementalRouter::computeShortestPath(int handle, Route& route) {
+    const int* targets = csr->targets.begin();
+    int start = route.start;
+
+    if (route.queue.size() > INCREMENTAL_QUEUE_SLACK * route.g.getSize() + 64) compactQueue(route);
+
+    while (!route.queue.empty()) {
+        QueueEntry top = route.queue.top();
+        int u = top.nodeID;
+        if (top.version != route.queuedVersion[u] || route.g[u] == route.rhs[u]) {
+            route.queue.pop();      // Superseded or already consistent
+            continue;
+        }
+
+        double startK1, startK2;
+        calcKey(route, start, startK1, startK2);
+        bool topBelowStart = (top.k1 < startK1) || (top.k1 == startK1 && top.k2 < startK2);
+        if (!topBelowStart && route.rhs[start] == route.g[start]) break;
+
+        route.queue.pop();
+        double k1, k2;
+        calcKey(route, u, k1, k2);
+        if (top.k1 < k1 || (top.k1 == k1 && top.k2 < k2)) {
+            // Key grew since it was queued (the start moved on)
+            route.queue.push(QueueEntry(u, k1, k2, ++route.queuedVersion[u]));
+            continue;
+        }
+
+        expansions++;
+        int end = csr->rowStart[u] + csr->rowDegree[u];
+        if (route.g[u] > route.rhs[u]) {
+            route.g[u] = route.rhs[u];
+            watch(handle, route, u);
+        }
+        else {
+            // Underconsistent: raise it and let rhs settle again (rhs may be unchanged, key is not)
+            route.g[u] = INF;
+            if (!updateVertex(route, u) && route.g[u] != route.rhs[u]) enqueue(route, u);
+        }
+        for (int k = csr->rowStart[u]; k < end; k++) {
+            updateVertex(route, targets[k]);
+        }
+    }
+}
+
+// ==================== ROUTE QUERIES ====================
+
+inline void IncrementalRouter::moveStart(int handle, int nodeID) {
+    Route* route = getRoute(handle);
+    if (!route || nodeID < 0 || nodeID >= csr->getNodeCount() || nodeID == route->start) return;
+
+    route->start = nodeID;
+    if (route->needsReset) return;
+    route->km += estimate(route->last, nodeID);
+    route->last = nodeID;
+}
+
+inline Vector<int> IncrementalRouter::getPath(int handle, double& totalDistance) {
+    Vector<int> path;
+    totalDistance = 0.0;
+
+    Route* route = getRoute(handle);
+    if (!route) return path;
+
+    if (route->needsReset) reset(handle, *route);
+    computeShortestPath(handle, *route);
+    route->affected = false;
+
+    if (route->g[route->start] >= INF) return path;
+
+    // Follow the cheapest road into the goal-distance field; ties go to the smaller g so
+    // zero-length roads cannot bounce the walk back and forth
+    const int* targets = csr->targets.begin();
+    const double* weights = csr->dynamicWeights.begin();
+    int nodeCount = csr->getNodeCount();
+
+    int u = route->start;
+    path.push_back(u);
+    while (u != route->goal) {
+        int next = -1;
+        double nextCost = INF;
+        double nextWeight = 0.0;
+        int end = csr->rowStart[u] + csr->rowDegree[u];
+        for (int k = csr->rowStart[u]; k < end; k++) {
+            int v = targets[k];
+            double gv = route->g[v];
+            if (gv >= INF) continue;
+            double candidate = cost(weights[k]) + gv;
+            if (candidate < nextCost || (candidate == nextCost && next != -1 && gv < route->g[next])) {
+                next = v;
+                nextCost = candidate;
+                nextWeight = weights[k];
+            }
+        }
+        if (next == -1 || path.getSize() > nodeCount) {
+            path.clear();
+            totalDistance = 0.0;
+            return path;
+        }
+        totalDistance += nextWeight;
+        path.push_back(next);
+        u = next;
+    }
+    return path;
+}
+
+// ==================== MAINTENANCE ====================
+
+// Road fromNode->toNode changed weight: every route with a finite g(toNode) re-derives rhs(fromNode)
+inline void IncrementalRouter::onEdgeChanged(int fromNode, int toNode) {
+    if (toNode < 0 || toNode >= watchers.getSize()) return;
+
+    // Only routes between a reset and their next one are registered, so every entry is live
+    Vector<Watch>& list = watchers[toNode];
+    for (int i = 0; i < list.getSize(); i++) {
+        Route* route = routes[list[i].handle];
+        if (fromNode < route->g.getSize() && updateVertex(*route, fromNode)) {
+            route->affected = true;
+        }
+    }
+}
+
+inline void IncrementalRouter::invalidateAll() {
+    for (int i = 0; i < routes.getSize(); i++) {
+        Route* route = routes[i];
+        if (route->active) route->needsReset = true;
+        for (int k = 0; k < route->watchedNodes.getSize(); k++) {
+            route->watched[route->watchedNodes[k].node] = 0;
+        }
+        route->watchedNodes.clear();
+    }
+    watchers = Vector<Vector<Watch>>();
+}
@@ -0,0 +1,205 @@
+#pragma once
+#include "CityUtils.h"
+
+// ==================== ROUTE CACHE ====================
+// Bounded LRU cache of point-to-point routes keyed on (start, end, metric).
+// Instead of being purged on every change, entries remember the epochs they were computed in:
+//  - the topology epoch moves on every road added or removed and voids all entries;
+//  - the traffic epoch moves on every CityGraph::updateTrafficWeights and voids dynamic-weight
+//    entries once they are more than stalenessTolerance epochs old (0 = exact).
+// Stale entries are dropped lazily when they are looked up or fall off the LRU tail.
+
+constexpr int ROUTE_CACHE_DEFAULT_CAPACITY = 1024;
+
+class RouteCache {
+private:
+    struct Entry {
+        long long key;
+        Vector<int> path;
+        double distance;
+        unsigned int topologyEpoch;
+        unsigned int trafficEpoch;
+        int prev;   // Towards the most recently used entry
+        int next;   // Towards the least recently used entry
+
+        Entry() : key(-1), distance(0.0), topologyEpoch(0), trafficEpoch(0), prev(-1), next(-1) {}
+    };
+
+    Vector<Entry> entries;
+    HashTable<long long, int>* index;   // key -> slot in entries
+    int capacity;
+    int used;
+    int head;                       // Most recently used slot
+    int tail;                       // Least recently used slot
+    int freeList;                   // Slots released by invalidation, chained through next
+
+    unsigned int topologyEpoch;
+    unsigned int trafficEpoch;
+    int stalenessTolerance;
+
+    long long hits;
+    long long misses;
+
+    static long long makeKey(int start, int end, bool dynamic) {
+        return ((long long)start << 32) | ((long long)end << 1) | (dynamic ? 1 : 0);
+    }
+
+    void unlink(int slot);
+    void pushFront(int slot);
+    void release(int slot);
+    bool isFresh(const Entry& entry, bool dynamic) const;
+
+public:
+    RouteCache(int cap = ROUTE_CACHE_DEFAULT_CAPACITY);
+    ~RouteCache();
+
+    RouteCache(const RouteCache&) = delete;
+    RouteCache& operator=(const RouteCache&) = delete;
+
+    // Returns true and fills path/distance if a fresh route is cached
+    bool find(int start, int end, bool dynamic, Vector<int>& path, double& distance);
+    void store(int start, int end, bool dynamic, const Vector<int>& path, double distance);
+
+    void bumpTopologyEpoch() { topologyEpoch++; }
+    void bumpTrafficEpoch() { trafficEpoch++; }
+
+    void setCapacity(int cap);     // Also empties the cache; 0 disables caching
+    void setStalenessTolerance(int epochs) { stalenessTolerance = (epochs < 0) ? 0 : epochs; }
+    void clear();
+
+    RouteCacheStats getStats() const;
+    void resetStats() { hits = 0; misses = 0; }
+};
+
+
+
+// ==================== CONSTRUCTOR / DESTRUCTOR ====================
+
+inline RouteCache::RouteCache(int cap)
+    : index(nullptr), capacity(0), used(0), head(-1), tail(-1), freeList(-1),
+    topologyEpoch(0), trafficEpoch(0), stalenessTolerance(0), hits(0), misses(0) {
+    setCapacity(cap);
+}
+
+inline RouteCache::~RouteCache() {
+    delete index;
+}
+
+inline void RouteCache::setCapacity(int cap) {
+    capacity = (cap < 0) ? 0 : cap;
+    delete index;
+    index = new HashTable<long long, int>(capacity);
+    entries = Vector<Entry>();
+    entries.resize(capacity);
+    used = 0;
+    head = tail = freeList = -1;
+}
+
+inline void RouteCache::clear() {
+    setCapacity(capacity);
+}
+
+// ==================== LRU LIST ====================
+
+inline void RouteCache::unlink(int slot) {
+    Entry& entry = entries[slot];
+    if (entry.prev != -1) entries[entry.prev].next = entry.next;
+    else head = entry.next;
+    if (entry.next != -1) entries[entry.next].prev = entry.prev;
+    else tail = entry.prev;
+    entry.prev = entry.next = -1;
+}
+
+inline void RouteCache::pushFront(int slot) {
+    Entry& entry = entries[slot];
+    entry.prev = -1;
+    entry.next = head;
+    if (head != -1) entries[head].prev = slot;
+    head = slot;
+    if (tail == -1) tail = slot;
+}
+
+inline void RouteCache::release(int slot) {
+    unlink(slot);
+    index->remove(entries[slot].key);
+    entries[slot].key = -1;
+    entries[slot].path.clear();
+    entries[slot].next = freeList;
+    freeList = slot;
+}
+
+inline bool RouteCache::isFresh(const Entry& entry, bool dynamic) const {
+    if (entry.topologyEpoch != topologyEpoch) return false;
+    if (!dynamic) return true;
+    return trafficEpoch - entry.trafficEpoch <= (unsigned int)stalenessTolerance;
+}
+
+// ==================== LOOKUP / STORE ====================
+
+inline bool RouteCache::find(int start, int end, bool dynamic, Vector<int>& path, double& distance) {
+    if (capacity == 0) return false;
+
+    long long key = makeKey(start, end, dynamic);
+    int* slot = index->get(key);
+    if (!slot) {
+        misses++;
+        return false;
+    }
+
+    int s = *slot;
+    if (!isFresh(entries[s], dynamic)) {
+        release(s);
+        misses++;
+        return false;
+    }
+
+    unlink(s);
+    pushFront(s);
+    path = entries[s].path;
+    distance = entries[s].distance;
+    hits++;
+    return true;
+}
+
+inline void RouteCache::store(int start, int end, bool dynamic, const Vector<int>& path, double distance) {
+    if (capacity == 0) return;
+
+    long long key = makeKey(start, end, dynamic);
+    int s;
+    int* existing = index->get(key);
+    if (existing) {
+        s = *existing;
+        unlink(s);
+    }
+    else if (freeList != -1) {
+        s = freeList;
+        freeList = entries[s].next;
+    }
+    else if (used < capacity) {
+        s = used++;
+    }
+    else {
+        // Full: recycle the least recently used slot
+        s = tail;
+        unlink(s);
+        index->remove(entries[s].key);
+    }
+
+    Entry& entry = entries[s];
+    entry.key = key;
+    entry.path = path;
+    entry.distance = distance;
+    entry.topologyEpoch = topologyEpoch;
+    entry.trafficEpoch = trafficEpoch;
+    index->insert(key, s);
+    pushFront(s);
+}
+
+inline RouteCacheStats RouteCache::getStats() const {
+    RouteCacheStats stats;
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.entries = index->getSize();
+    stats.capacity = capacity;
+    return stats;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <chrono>
+#include <cmath>
+#include <random>
+#include "CityGraph.h"
+
+// ==================== ROUTING BENCHMARK ====================
+// Development tool, not used by the simulation: times every search mode on the same random
+// static-weight queries and checks each against plain Dijkstra.
+// It changes the graph it measures: the contraction hierarchy and the sector overlay are
+// rebuilt so their build costs are included, and the route cache is switched off for the run
+// (so repeated pairs are really searched) and comes back empty at its old capacity.
+
+// All timings in milliseconds, over the same query pairs
+struct RoutingBenchmark {
+    int queries;
+    int shortcuts;
+    int mismatches;         // Queries whose distance differs from plain Dijkstra
+    double hierarchyBuildMs;
+    double dijkstraMs;
+    double astarMs;
+    double bidirectionalMs;
+    double hierarchyMs;
+    double overlayBuildMs;
+    double overlayMs;
+
+    RoutingBenchmark()
+        : queries(0), shortcuts(0), mismatches(0), hierarchyBuildMs(0.0),
+        dijkstraMs(0.0), astarMs(0.0), bidirectionalMs(0.0), hierarchyMs(0.0),
+        overlayBuildMs(0.0), overlayMs(0.0) {}
+};
+
+// The query pairs depend only on seed and the node count
+inline RoutingBenchmark benchmarkRouting(CityGraph& graph, int queryCount = 200, unsigned int seed = 1) {
+    RoutingBenchmark result;
+    int nodeCount = graph.getNodeCount();
+    if (nodeCount < 2 || queryCount <= 0) return result;
+
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> pickNode(0, nodeCount - 1);
+    Vector<int> starts, ends;
+    for (int i = 0; i < queryCount; i++) {
+        starts.push_back(pickNode(rng));
+        ends.push_back(pickNode(rng));
+    }
+
+    Vector<double> reference;
+    reference.resize(queryCount, 0.0);
+
+    RouteSearchMode modes[5] = {
+        RouteSearchMode::DIJKSTRA, RouteSearchMode::ASTAR, RouteSearchMode::BIDIRECTIONAL,
+        RouteSearchMode::HIERARCHY, RouteSearchMode::SECTOR_OVERLAY
+    };
+    double* timings[5] = {
+        &result.dijkstraMs, &result.astarMs, &result.bidirectionalMs, &result.hierarchyMs, &result.overlayMs
+    };
+
+    auto buildStart = std::chrono::steady_clock::now();
+    graph.buildContractionHierarchy();
+    auto buildEnd = std::chrono::steady_clock::now();
+    result.hierarchyBuildMs = std::chrono::duration<double, std::milli>(buildEnd - buildStart).count();
+    result.shortcuts = graph.getHierarchyShortcutCount();
+
+    buildStart = std::chrono::steady_clock::now();
+    graph.buildSectorOverlay();
+    buildEnd = std::chrono::steady_clock::now();
+    result.overlayBuildMs = std::chrono::duration<double, std::milli>(buildEnd - buildStart).count();
+
+    int cacheCapacity = graph.getRouteCacheStats().capacity;
+    graph.setRouteCacheCapacity(0);
+
+    for (int m = 0; m < 5; m++) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < queryCount; i++) {
+            double dist = 0.0;
+            graph.findShortestPath(starts[i], ends[i], dist, modes[m]);
+            if (m == 0) reference[i] = dist;
+            else if (std::abs(dist - reference[i]) > 1e-6) result.mismatches++;
+        }
+        auto end = std::chrono::steady_clock::now();
+        *timings[m] = std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    graph.setRouteCacheCapacity(cacheCapacity);
+    result.queries = queryCount;
+    return result;
+}
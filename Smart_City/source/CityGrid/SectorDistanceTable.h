@@ -0,0 +1,186 @@
+#pragma once
+#include <iomanip>
+#include "CityUtils.h"
+
+// ==================== SECTOR DISTANCE TABLE ====================
+// Static road distance between every pair of sectors, measured between their centre
+// intersections (gridCorners[2][2]). Lookups are a plain array read, so sector-level
+// heuristics can rank by real travel distance instead of grid adjacency.
+// The table is tagged with a signature of the road network it was computed on; a saved
+// copy is only accepted by load() when the signature still matches.
+//
+// File format (CSV):
+//   signature,<road network signature>
+//   from,<sector 0>,<sector 1>,...
+//   <sector i>,<distance i->0>,<distance i->1>,...     (-1 = not connected)
+
+constexpr int SECTOR_CENTRE_ROW = 2;
+constexpr int SECTOR_CENTRE_COL = 2;
+
+class SectorDistanceTable {
+private:
+    double distance[SECTOR_COUNT][SECTOR_COUNT];
+    unsigned long long signature;
+    bool built;
+
+    // order[i]: the other sectors reachable from i, nearest first (ties by index)
+    int order[SECTOR_COUNT][SECTOR_COUNT - 1];
+    int orderCount[SECTOR_COUNT];
+    void sortRows();
+
+public:
+    SectorDistanceTable();
+
+    // matrix is row-major SECTOR_COUNT x SECTOR_COUNT in SECTOR_GRID order (INF = not connected)
+    void assign(const Vector<double>& matrix, unsigned long long networkSignature);
+
+    // Marks the table stale; cheap enough to call on every road change
+    void clear() { built = false; }
+
+    bool isBuilt() const { return built; }
+    unsigned long long getSignature() const { return signature; }
+
+    // SECTOR_GRID indices; INF if either index is invalid or the sectors are not connected
+    double get(int fromSector, int toSector) const;
+    // Sectors by distance from fromSector (count = 0 for an invalid index); valid until the next assign/load
+    const int* getOrder(int fromSector, int& count) const;
+
+    bool save(const string& filename) const;
+    // False (and the table is left untouched) if the file is missing, malformed or stale
+    bool load(const string& filename, unsigned long long expectedSignature);
+};
+
+
+
+// ==================== CONSTRUCTOR ====================
+
+inline SectorDistanceTable::SectorDistanceTable() : signature(0), built(false) {
+    for (int i = 0; i < SECTOR_COUNT; i++) {
+        for (int j = 0; j < SECTOR_COUNT; j++) {
+            distance[i][j] = INF;
+        }
+        orderCount[i] = 0;
+    }
+}
+
+// ==================== ACCESS ====================
+
+inline void SectorDistanceTable::assign(const Vector<double>& matrix, unsigned long long networkSignature) {
+    if (matrix.getSize() != SECTOR_COUNT * SECTOR_COUNT) return;
+    for (int i = 0; i < SECTOR_COUNT; i++) {
+        for (int j = 0; j < SECTOR_COUNT; j++) {
+            distance[i][j] = matrix[i * SECTOR_COUNT + j];
+        }
+    }
+    signature = networkSignature;
+    built = true;
+    sortRows();
+}
+
+inline double SectorDistanceTable::get(int fromSector, int toSector) const {
+    if (fromSector < 0 || fromSector >= SECTOR_COUNT || toSector < 0 || toSector >= SECTOR_COUNT) return INF;
+    return distance[fromSector][toSector];
+}
+
+inline const int* SectorDistanceTable::getOrder(int fromSector, int& count) const {
+    if (fromSector < 0 || fromSector >= SECTOR_COUNT) {
+        count = 0;
+        return nullptr;
+    }
+    count = orderCount[fromSector];
+    return order[fromSector];
+}
+
+// Insertion sort per row (29 entries); unreachable sectors are left out
+inline void SectorDistanceTable::sortRows() {
+    for (int i = 0; i < SECTOR_COUNT; i++) {
+        int count = 0;
+        for (int j = 0; j < SECTOR_COUNT; j++) {
+            double d = distance[i][j];
+            if (j == i || d >= INF) continue;
+
+            int pos = count++;
+            while (pos > 0 && distance[i][order[i][pos - 1]] > d) {
+                order[i][pos] = order[i][pos - 1];
+                pos--;
+            }
+            order[i][pos] = j;
+        }
+        orderCount[i] = count;
+    }
+}
+
+// ==================== PERSISTENCE ====================
+
+inline bool SectorDistanceTable::save(const string& filename) const {
+    if (!built) return false;
+    ofstream file(filename);
+    if (!file.is_open()) return false;
+
+    file << "signature," << signature << "\n";
+    file << "from";
+    for (int j = 0; j < SECTOR_COUNT; j++) file << "," << SECTOR_GRID[j].name;
+    file << "\n";
+
+    // Full precision so a loaded table matches a freshly computed one exactly
+    file << std::setprecision(17);
+    for (int i = 0; i < SECTOR_COUNT; i++) {
+        file << SECTOR_GRID[i].name;
+        for (int j = 0; j < SECTOR_COUNT; j++) {
+            file << "," << ((distance[i][j] >= INF) ? -1.0 : distance[i][j]);
+        }
+        file << "\n";
+    }
+    return file.good();
+}
+
+inline bool SectorDistanceTable::load(const string& filename, unsigned long long expectedSignature) {
+    ifstream file(filename);
+    if (!file.is_open()) return false;
+
+    string line;
+    if (!getline(file, line)) return false;
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (line != "signature," + std::to_string(expectedSignature)) return false;
+    if (!getline(file, line)) return false;     // Column names
+
+    double loaded[SECTOR_COUNT][SECTOR_COUNT];
+    for (int i = 0; i < SECTOR_COUNT; i++) {
+        if (!getline(file, line)) return false;
+
+        Vector<string> fields;
+        string field;
+        for (int k = 0; k < (int)line.size(); k++) {
+            char c = line[k];
+            if (c == ',') {
+                fields.push_back(field);
+                field = "";
+            }
+            else if (c != '\r') {
+                field += c;
+            }
+        }
+        fields.push_back(field);
+        if (fields.getSize() != SECTOR_COUNT + 1 || fields[0] != SECTOR_GRID[i].name) return false;
+
+        for (int j = 0; j < SECTOR_COUNT; j++) {
+            try {
+                double value = std::stod(fields[j + 1]);
+                loaded[i][j] = (value < 0.0) ? INF : value;
+            }
+            catch (...) {
+                return false;
+            }
+        }
+    }
+
+    for (int i = 0; i < SECTOR_COUNT; i++) {
+        for (int j = 0; j < SECTOR_COUNT; j++) {
+            distance[i][j] = loaded[i][j];
+        }
+    }
+    signature = expectedSignature;
+    built = true;
+    sortRows();
+    return true;
+}
@@ -0,0 +1,202 @@
+#pragma once
+#include "CityUtils.h"
+
+// ==================== SECTOR OVERLAY ====================
+// Two-level routing data over the sector partition.
+// Every node belongs to the cell of its sector (nodes outside all sectors share one extra
+// cell). A boundary node has a road into another cell. For every cell, the overlay stores
+// the shortest within-cell distance between each pair of its boundary nodes, for both the
+// static and the dynamic metric, minus the arcs that a route through another boundary node
+// of the cell already matches. A query only expands the start and end cells road by road;
+// everywhere else it hops between boundary nodes over these clique arcs and the cut roads.
+// The partition and static cliques are rebuilt after any road change; the dynamic cliques
+// are re-customized after each traffic update.
+
+constexpr int OVERLAY_CELL_COUNT = SECTOR_COUNT + 1;   // Last cell holds nodes outside every sector
+constexpr int OVERLAY_CLIQUE_ARC = 1;                  // SearchWorkspace::parentArc tag for a clique hop
+
+class SectorOverlay {
+public:
+    struct Arc {
+        int target;
+        double weight;
+
+        Arc() : target(-1), weight(INF) {}
+        Arc(int t, double w) : target(t), weight(w) {}
+    };
+
+private:
+    int nodeCount;
+    bool built;
+    bool dynamicCurrent;
+
+    Vector<int> cellOf;                     // Node -> cell
+    Vector<int> boundaryPos;                // Node -> index in its cell's boundary list (-1 if interior)
+    Vector<Vector<int>> boundary;           // Cell -> boundary nodes
+    Vector<Vector<Arc>> staticArcs;         // Boundary node -> clique arcs on Edge::weight
+    Vector<Vector<Arc>> dynamicArcs;        // Boundary node -> clique arcs on Edge::dynamicWeight
+
+    void customize(const RoadCSR& csr, const double* weights, Vector<Vector<Arc>>& arcs, SearchWorkspace& ws);
+
+public:
+    SectorOverlay() : nodeCount(0), built(false), dynamicCurrent(false) {}
+
+    // cells[v] is node v's cell in [0, OVERLAY_CELL_COUNT)
+    void build(const RoadCSR& csr, const Vector<int>& cells, SearchWorkspace& ws);
+    void ensureDynamic(const RoadCSR& csr, SearchWorkspace& ws);
+
+    void clear() { built = false; }
+    void invalidateTraffic() { dynamicCurrent = false; }
+    bool isBuilt() const { return built; }
+
+    int getCell(int node) const { return cellOf[node]; }
+    bool isBoundary(int node) const { return boundaryPos[node] != -1; }
+    int getBoundaryCount() const;
+    int getCliqueArcCount() const;
+    const Vector<int>& getBoundary(int cell) const { return boundary[cell]; }
+    const Vector<Arc>& getCliqueArcs(int node, bool dynamic) const {
+        return dynamic ? dynamicArcs[node] : staticArcs[node];
+    }
+
+    // Dijkstra from startID that never leaves its cell (stops early once stopAt is settled)
+    void searchCell(const RoadCSR& csr, const double* weights, int startID, int stopAt, SearchWorkspace& ws) const;
+
+    // Appends the road-level nodes of clique hop from->to (excluding from) to the path
+    void expandClique(const RoadCSR& csr, const double* weights, int from, int to,
+        SearchWorkspace& ws, Vector<int>& path) const;
+};
+
+
+
+// ==================== BUILD / CUSTOMIZE ====================
+
+inline void SectorOverlay::build(const RoadCSR& csr, const Vector<int>& cells, SearchWorkspace& ws) {
+    nodeCount = cells.getSize();
+    cellOf = cells;
+
+    boundaryPos = Vector<int>();
+    boundaryPos.resize(nodeCount, -1);
+    boundary = Vector<Vector<int>>();
+    boundary.resize(OVERLAY_CELL_COUNT);
+
+    const int* targets = csr.targets.begin();
+    for (int u = 0; u < nodeCount; u++) {
+        int end = csr.rowStart[u] + csr.rowDegree[u];
+        for (int k = csr.rowStart[u]; k < end; k++) {
+            if (cellOf[targets[k]] != cellOf[u]) {
+                boundaryPos[u] = boundary[cellOf[u]].getSize();
+                boundary[cellOf[u]].push_back(u);
+                break;
+            }
+        }
+    }
+
+    customize(csr, csr.weights.begin(), staticArcs, ws);
+    built = true;
+    dynamicCurrent = false;
+}
+
+inline void SectorOverlay::ensureDynamic(const RoadCSR& csr, SearchWorkspace& ws) {
+    if (dynamicCurrent) return;
+    customize(csr, csr.dynamicWeights.begin(), dynamicArcs, ws);
+    dynamicCurrent = true;
+}
+
+// Within-cell distances between every pair of boundary nodes, one cell-restricted Dijkstra
+// per boundary node. An arc i->j is dropped when some other boundary node k gives an equally
+// short route through two strictly shorter arcs: those are kept (or themselves replaced by
+// shorter ones), so every dropped distance stays reachable. Zero-length hops never justify a
+// drop, which keeps co-located boundary nodes from pruning each other's arcs.
+inline void SectorOverlay::customize(const RoadCSR& csr, const double* weights,
+    Vector<Vector<Arc>>& arcs, SearchWorkspace& ws) {
+    arcs = Vector<Vector<Arc>>();
+    arcs.resize(nodeCount);
+
+    Vector<double> table;
+    for (int c = 0; c < OVERLAY_CELL_COUNT; c++) {
+        const Vector<int>& nodesOnBoundary = boundary[c];
+        int m = nodesOnBoundary.getSize();
+        table = Vector<double>();
+        table.resize(m * m, INF);
+
+        for (int i = 0; i < m; i++) {
+            searchCell(csr, weights, nodesOnBoundary[i], -1, ws);
+            for (int j = 0; j < m; j++) {
+                table[i * m + j] = ws.getDistance(nodesOnBoundary[j]);
+            }
+        }
+
+        for (int i = 0; i < m; i++) {
+            for (int j = 0; j < m; j++) {
+                double direct = table[i * m + j];
+                if (i == j || direct >= INF) continue;
+
+                bool covered = false;
+                for (int k = 0; k < m && !covered; k++) {
+                    double first = table[i * m + k];
+                    double second = table[k * m + j];
+                    covered = (k != i && k != j && first < direct && second < direct
+                        && first + second <= direct);
+                }
+                if (!covered) arcs[nodesOnBoundary[i]].push_back(Arc(nodesOnBoundary[j], direct));
+            }
+        }
+    }
+}
+
+inline int SectorOverlay::getBoundaryCount() const {
+    int total = 0;
+    for (int c = 0; c < boundary.getSize(); c++) total += boundary[c].getSize();
+    return total;
+}
+
+inline int SectorOverlay::getCliqueArcCount() const {
+    int total = 0;
+    for (int v = 0; v < staticArcs.getSize(); v++) total += staticArcs[v].getSize();
+    return total;
+}
+
+// ==================== CELL SEARCH ====================
+
+inline void SectorOverlay::searchCell(const RoadCSR& csr, const double* weights, int startID, int stopAt,
+    SearchWorkspace& ws) const {
+    ws.begin(nodeCount);
+
+    const int* targets = csr.targets.begin();
+    int cell = cellOf[startID];
+
+    ws.setDistance(startID, 0.0, -1);
+    ws.heap.push(DijkstraNode(startID, 0.0));
+
+    while (!ws.heap.empty()) {
+        DijkstraNode current = ws.heap.top();
+        ws.heap.pop();
+
+        int u = current.nodeID;
+        if (ws.isSettled(u)) continue;
+        ws.settle(u);
+
+        if (u == stopAt) break;
+
+        int end = csr.rowStart[u] + csr.rowDegree[u];
+        for (int k = csr.rowStart[u]; k < end; k++) {
+            int v = targets[k];
+            if (cellOf[v] != cell) continue;
+
+            double candidate = current.distance + weights[k];
+            if (!ws.isSettled(v) && candidate < ws.getDistance(v)) {
+                ws.setDistance(v, candidate, u);
+                ws.heap.push(DijkstraNode(v, candidate));
+            }
+        }
+    }
+}
+
+inline void SectorOverlay::expandClique(const RoadCSR& csr, const double* weights, int from, int to,
+    SearchWorkspace& ws, Vector<int>& path) const {
+    searchCell(csr, weights, from, to, ws);
+    Vector<int> hop = ws.tracePath(to);
+    for (int i = 1; i < hop.getSize(); i++) {
+        path.push_back(hop[i]);
+    }
+}
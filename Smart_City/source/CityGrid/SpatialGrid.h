@@ -0,0 +1,202 @@
+#pragma once
+#include "CityUtils.h"
+
+// ==================== SPATIAL GRID ====================
+// Uniform bucket grid over a lat/lon rectangle for point lookups by position.
+// Items are dense non-negative IDs (graph nodes, render-list indices, ...) with a position
+// each; every bucket is cellKm x cellKm, so radius and nearest-neighbour queries only
+// touch the buckets around the query point. Distances are GeometryUtils::getGridDistance km.
+// Points outside the rectangle are kept in the nearest edge bucket and still found.
+
+constexpr double SPATIAL_GRID_CELL_KM = 0.25;  // About a quarter of a sub-sector cell
+
+class SpatialGrid {
+private:
+    double minLat, minLon;
+    double cellLat, cellLon;        // Bucket size in degrees
+    double cellKm;
+    int rows, cols;
+
+    Vector<Vector<int>> buckets;    // Row-major bucket -> item IDs
+    Vector<double> itemLat;
+    Vector<double> itemLon;
+    Vector<int> itemBucket;         // Item -> bucket (-1 = not stored)
+    Vector<int> itemSlot;           // Item -> position in its bucket
+    int itemCount;
+
+    int rowOf(double lat) const;
+    int colOf(double lon) const;
+    void unlink(int id);
+
+public:
+    SpatialGrid(double minLa = BASE_LAT, double maxLa = MAX_LAT, double minLo = BASE_LON, double maxLo = MAX_LON,
+        double cellSizeKm = SPATIAL_GRID_CELL_KM);
+
+    // Adds the item, or moves it if it is already stored
+    void insert(int id, double lat, double lon);
+    void remove(int id);
+    void clear();
+
+    bool contains(int id) const { return id >= 0 && id < itemBucket.getSize() && itemBucket[id] != -1; }
+    int getSize() const { return itemCount; }
+
+    // Calls visit(id, distanceKm) for every item within radiusKm of the point
+    template <typename Visit>
+    void forEachInRadius(double lat, double lon, double radiusKm, Visit visit) const;
+    Vector<int> findInRadius(double lat, double lon, double radiusKm) const;
+
+    // Closest item accepted by accept(id) within maxDistanceKm (-1 if none); ties go to the lower ID
+    template <typename Accept>
+    int findNearest(double lat, double lon, double maxDistanceKm, Accept accept) const;
+    int findNearest(double lat, double lon, double maxDistanceKm = INF) const;
+};
+
+
+
+// ==================== CONSTRUCTOR ====================
+
+inline SpatialGrid::SpatialGrid(double minLa, double maxLa, double minLo, double maxLo, double cellSizeKm)
+    : minLat(minLa), minLon(minLo), cellKm(cellSizeKm), itemCount(0) {
+    cellLat = cellKm / KM_PER_LAT_DEGREE;
+    cellLon = cellKm / KM_PER_LON_DEGREE;
+    rows = (int)std::ceil((maxLa - minLa) / cellLat);
+    cols = (int)std::ceil((maxLo - minLo) / cellLon);
+    if (rows < 1) rows = 1;
+    if (cols < 1) cols = 1;
+    buckets.resize(rows * cols);
+}
+
+// ==================== BUCKETS ====================
+
+inline int SpatialGrid::rowOf(double lat) const {
+    double r = std::floor((lat - minLat) / cellLat);
+    if (!(r >= 0.0)) return 0;      // Also catches NaN
+    return (r >= rows) ? rows - 1 : (int)r;
+}
+
+inline int SpatialGrid::colOf(double lon) const {
+    double c = std::floor((lon - minLon) / cellLon);
+    if (!(c >= 0.0)) return 0;
+    return (c >= cols) ? cols - 1 : (int)c;
+}
+
+// Swap-remove from the bucket, patching the slot of the item moved into the hole
+inline void SpatialGrid::unlink(int id) {
+    Vector<int>& bucket = buckets[itemBucket[id]];
+    int slot = itemSlot[id];
+    int last = bucket[bucket.getSize() - 1];
+    bucket[slot] = last;
+    itemSlot[last] = slot;
+    bucket.pop_back();
+    itemBucket[id] = -1;
+    itemSlot[id] = -1;
+}
+
+inline void SpatialGrid::insert(int id, double lat, double lon) {
+    if (id < 0) return;
+    if (id >= itemBucket.getSize()) {
+        itemLat.resize(id + 1, 0.0);
+        itemLon.resize(id + 1, 0.0);
+        itemBucket.resize(id + 1, -1);
+        itemSlot.resize(id + 1, -1);
+    }
+
+    int bucket = rowOf(lat) * cols + colOf(lon);
+    itemLat[id] = lat;
+    itemLon[id] = lon;
+    if (itemBucket[id] == bucket) return;
+
+    if (itemBucket[id] != -1) unlink(id);
+    else itemCount++;
+    itemBucket[id] = bucket;
+    itemSlot[id] = buckets[bucket].getSize();
+    buckets[bucket].push_back(id);
+}
+
+inline void SpatialGrid::remove(int id) {
+    if (!contains(id)) return;
+    unlink(id);
+    itemCount--;
+}
+
+inline void SpatialGrid::clear() {
+    for (int b = 0; b < buckets.getSize(); b++) {
+        buckets[b].clear();
+    }
+    for (int i = 0; i < itemBucket.getSize(); i++) {
+        itemBucket[i] = -1;
+        itemSlot[i] = -1;
+    }
+    itemCount = 0;
+}
+
+// ==================== QUERIES ====================
+
+template <typename Visit>
+inline void SpatialGrid::forEachInRadius(double lat, double lon, double radiusKm, Visit visit) const {
+    if (!(radiusKm >= 0.0) || itemCount == 0) return;
+
+    int rowLo = rowOf(lat - radiusKm / KM_PER_LAT_DEGREE);
+    int rowHi = rowOf(lat + radiusKm / KM_PER_LAT_DEGREE);
+    int colLo = colOf(lon - radiusKm / KM_PER_LON_DEGREE);
+    int colHi = colOf(lon + radiusKm / KM_PER_LON_DEGREE);
+
+    for (int r = rowLo; r <= rowHi; r++) {
+        for (int c = colLo; c <= colHi; c++) {
+            const Vector<int>& bucket = buckets[r * cols + c];
+            for (int k = 0; k < bucket.getSize(); k++) {
+                int id = bucket[k];
+                double d = GeometryUtils::getGridDistance(lat, lon, itemLat[id], itemLon[id]);
+                if (d <= radiusKm) visit(id, d);
+            }
+        }
+    }
+}
+
+inline Vector<int> SpatialGrid::findInRadius(double lat, double lon, double radiusKm) const {
+    Vector<int> result;
+    forEachInRadius(lat, lon, radiusKm, [&](int id, double) { result.push_back(id); });
+    return result;
+}
+
+// Scans rings of buckets outwards from the query's bucket. Anything in ring k + 1 is at
+// least k buckets away, so once the best match is that close no further ring can beat it.
+template <typename Accept>
+inline int SpatialGrid::findNearest(double lat, double lon, double maxDistanceKm, Accept accept) const {
+    if (!(maxDistanceKm >= 0.0) || itemCount == 0) return -1;
+
+    int row = rowOf(lat);
+    int col = colOf(lon);
+    int maxRing = (rows > cols) ? rows : cols;
+
+    int best = -1;
+    double bestDistance = maxDistanceKm;
+    for (int ring = 0; ring <= maxRing; ring++) {
+        if ((ring - 1) * cellKm > bestDistance) break;
+
+        for (int r = row - ring; r <= row + ring; r++) {
+            if (r < 0 || r >= rows) continue;
+            // Interior rows of the ring only contribute their two end buckets
+            bool edgeRow = (r == row - ring || r == row + ring);
+            int step = (edgeRow || ring == 0) ? 1 : 2 * ring;
+            for (int c = col - ring; c <= col + ring; c += step) {
+                if (c < 0 || c >= cols) continue;
+
+                const Vector<int>& bucket = buckets[r * cols + c];
+                for (int k = 0; k < bucket.getSize(); k++) {
+                    int id = bucket[k];
+                    double d = GeometryUtils::getGridDistance(lat, lon, itemLat[id], itemLon[id]);
+                    if (d > bestDistance || (d == bestDistance && best != -1 && id > best)) continue;
+                    if (!accept(id)) continue;
+                    best = id;
+                    bestDistance = d;
+                }
+            }
+        }
+    }
+    return best;
+}
+
+inline int SpatialGrid::findNearest(double lat, double lon, double maxDistanceKm) const {
+    return findNearest(lat, lon, maxDistanceKm, [](int) { return true; });
+}
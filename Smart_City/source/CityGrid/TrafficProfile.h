@@ -0,0 +1,170 @@
+#pragma once
+#include "CityUtils.h"
+
+// ==================== TRAFFIC PROFILES ====================
+// Learned load of every road by time of day, for routes that look ahead instead of pricing
+// the whole trip at the load of the moment it was asked for.
+// The day is cut into fixed buckets. While the simulation clock runs, every load change is
+// reported as it happens and integrated over the current bucket; when the bucket ends, each
+// road's mean load over it is blended into the road's value for that bucket. A bucket
+// predicts nothing until the clock has passed through it at least once.
+
+constexpr int MINUTES_PER_DAY = 24 * 60;
+constexpr int TRAFFIC_PROFILE_BUCKET_MINUTES = 15;
+constexpr int TRAFFIC_PROFILE_BUCKETS = MINUTES_PER_DAY / TRAFFIC_PROFILE_BUCKET_MINUTES;
+// Observations older than this many minutes of a bucket fade out (about the last four days)
+constexpr int TRAFFIC_PROFILE_MEMORY_MINUTES = 4 * TRAFFIC_PROFILE_BUCKET_MINUTES;
+// Free-flow travel speed used to turn route weights into arrival times
+// (simulated vehicles cover 0.2-0.25 km per one-minute tick on an empty road)
+constexpr double TRAFFIC_PROFILE_KM_PER_MINUTE = 0.2;
+
+class TrafficProfile {
+private:
+    Vector<float> meanLoad;         // edgeID * TRAFFIC_PROFILE_BUCKETS + bucket -> learned load
+    int observedMinutes[TRAFFIC_PROFILE_BUCKETS];   // Minutes of each bucket seen so far (capped)
+
+    // Current bucket: load integrated per edge since it started
+    Vector<int> liveLoad;           // Edge ID -> load as last reported
+    Vector<int> loadSince;          // Edge ID -> clock minute of that report
+    Vector<double> loadMinutes;     // Edge ID -> integral of the load before loadSince
+
+    int clock;                      // Minutes since the clock was first set
+    int dayOffset;                  // (clock + dayOffset) % MINUTES_PER_DAY = minute of the day
+    int bucketStart;                // Clock minute the current bucket started
+    bool running;
+
+    void grow(int edgeCount);
+    void closeBucket();
+    // Learned load at a bucket; false if the bucket was never observed
+    bool bucketLoad(int edgeID, int bucket, double& load) const;
+
+public:
+    TrafficProfile();
+
+    // Starts the clock, or jumps it without attributing the skipped time to any bucket
+    void setTimeOfDay(int minuteOfDay);
+    // Moves the clock forward, closing every bucket boundary it crosses (ignored before setTimeOfDay)
+    void advance(int minutes);
+    // Called whenever a road's load changes (both directions report separately)
+    void observe(int edgeID, int load);
+    // Forgets every learned bucket; the loads of the current bucket keep being recorded
+    void clear();
+
+    bool isRunning() const { return running; }
+    int getMinuteOfDay() const { return running ? (clock + dayOffset) % MINUTES_PER_DAY : 0; }
+    bool hasObserved(int bucket) const { return bucket >= 0 && bucket < TRAFFIC_PROFILE_BUCKETS && observedMinutes[bucket] > 0; }
+
+    // Learned load of the road at any minute of the day, interpolated between bucket centres;
+    // false where neither neighbouring bucket was observed yet
+    bool predictLoad(int edgeID, double minuteOfDay, double& load) const;
+};
+
+
+
+// ==================== CONSTRUCTOR ====================
+
+inline TrafficProfile::TrafficProfile()
+    : clock(0), dayOffset(0), bucketStart(0), running(false) {
+    for (int b = 0; b < TRAFFIC_PROFILE_BUCKETS; b++) observedMinutes[b] = 0;
+}
+
+// ==================== RECORDING ====================
+
+inline void TrafficProfile::grow(int edgeCount) {
+    if (edgeCount <= liveLoad.getSize()) return;
+    liveLoad.resize(edgeCount, 0);
+    loadSince.resize(edgeCount, clock);
+    loadMinutes.resize(edgeCount, 0.0);
+    meanLoad.resize(edgeCount * TRAFFIC_PROFILE_BUCKETS, 0.0f);
+}
+
+inline void TrafficProfile::observe(int edgeID, int load) {
+    if (edgeID < 0) return;
+    grow(edgeID + 1);
+
+    loadMinutes[edgeID] += (double)liveLoad[edgeID] * (clock - loadSince[edgeID]);
+    loadSince[edgeID] = clock;
+    liveLoad[edgeID] = load;
+}
+
+// Blends the mean load of every road over the bucket that just ended into its profile.
+// Roads never reported have been empty throughout and keep their zero.
+// The blend weight is the share of the bucket's remembered minutes this observation makes
+// up: a plain average while the bucket is new, an exponential moving average afterwards.
+inline void TrafficProfile::closeBucket() {
+    int minutes = clock - bucketStart;
+    int bucket = ((bucketStart + dayOffset) % MINUTES_PER_DAY) / TRAFFIC_PROFILE_BUCKET_MINUTES;
+    bucketStart = clock;
+    if (minutes <= 0) return;
+
+    int remembered = observedMinutes[bucket] + minutes;
+    if (remembered > TRAFFIC_PROFILE_MEMORY_MINUTES) remembered = TRAFFIC_PROFILE_MEMORY_MINUTES;
+    double rate = (double)minutes / (double)remembered;
+    if (rate > 1.0) rate = 1.0;
+    observedMinutes[bucket] = remembered;
+
+    float* mean = meanLoad.begin();
+    for (int e = 0; e < liveLoad.getSize(); e++) {
+        double observed = (loadMinutes[e] + (double)liveLoad[e] * (clock - loadSince[e])) / minutes;
+        float& slot = mean[e * TRAFFIC_PROFILE_BUCKETS + bucket];
+        slot = (float)(slot + rate * (observed - slot));
+        loadMinutes[e] = 0.0;
+        loadSince[e] = clock;
+    }
+}
+
+// ==================== CLOCK ====================
+
+inline void TrafficProfile::setTimeOfDay(int minuteOfDay) {
+    minuteOfDay %= MINUTES_PER_DAY;
+    if (minuteOfDay < 0) minuteOfDay += MINUTES_PER_DAY;
+
+    if (running) closeBucket();
+    running = true;
+    dayOffset = (minuteOfDay - clock % MINUTES_PER_DAY + MINUTES_PER_DAY) % MINUTES_PER_DAY;
+}
+
+inline void TrafficProfile::advance(int minutes) {
+    if (!running) return;
+
+    while (minutes > 0) {
+        int toBoundary = TRAFFIC_PROFILE_BUCKET_MINUTES - getMinuteOfDay() % TRAFFIC_PROFILE_BUCKET_MINUTES;
+        int step = (minutes < toBoundary) ? minutes : toBoundary;
+        clock += step;
+        minutes -= step;
+        if (step == toBoundary) closeBucket();
+    }
+}
+
+inline void TrafficProfile::clear() {
+    for (int b = 0; b < TRAFFIC_PROFILE_BUCKETS; b++) observedMinutes[b] = 0;
+    for (int i = 0; i < meanLoad.getSize(); i++) meanLoad[i] = 0.0f;
+}
+
+// ==================== PREDICTION ====================
+
+inline bool TrafficProfile::bucketLoad(int edgeID, int bucket, double& load) const {
+    if (observedMinutes[bucket] == 0) return false;
+    load = (edgeID >= 0 && edgeID < liveLoad.getSize()) ? meanLoad[edgeID * TRAFFIC_PROFILE_BUCKETS + bucket] : 0.0;
+    return true;
+}
+
+inline bool TrafficProfile::predictLoad(int edgeID, double minuteOfDay, double& load) const {
+    // Position relative to the bucket centres, so the prediction is continuous in time
+    double position = (minuteOfDay - 0.5 * TRAFFIC_PROFILE_BUCKET_MINUTES) / TRAFFIC_PROFILE_BUCKET_MINUTES;
+    double below = std::floor(position);
+    double t = position - below;
+
+    int first = (int)below % TRAFFIC_PROFILE_BUCKETS;
+    if (first < 0) first += TRAFFIC_PROFILE_BUCKETS;
+    int second = (first + 1) % TRAFFIC_PROFILE_BUCKETS;
+
+    double a = 0.0, b = 0.0;
+    bool hasA = bucketLoad(edgeID, first, a);
+    bool hasB = bucketLoad(edgeID, second, b);
+    if (hasA && hasB) load = a + t * (b - a);
+    else if (hasA) load = a;
+    else if (hasB) load = b;
+    else return false;
+    return true;
+}
@@ -18,8 +18,8 @@ public:
     Vector<Doctor> doctors;
     Vector<string> specializations;
 
-    // QUEUE (Min-Heap / Priority Queue)
-    PriorityQueue<Patient> emergencyRoom;
+    // QUEUE (Min-Heap / Priority Queue), keyed by severity: critical (1) first, then arrival order
+    HandlePriorityQueue<Patient> emergencyRoom;
 
     Location location;
     string graphNodeID;
@@ -75,7 +75,7 @@ public:
             return true;
         }
         else {
-            emergencyRoom.push(p);
+            emergencyRoom.push(p, p.severity);
             return false;
         }
     }
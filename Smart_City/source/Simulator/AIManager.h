@@ -38,7 +38,10 @@ private:
 public:
     AIManager(CityGraph* graph, PopulationManager* popMgr, TransportManager* transMgr)
         : cityGraph(graph), populationManager(popMgr), transportManager(transMgr),
-          currentSimHour(6), currentSimMinute(0), totalSimTicks(0) {}
+          currentSimHour(6), currentSimMinute(0), totalSimTicks(0) {
+        // The road network learns its time-of-day traffic profiles on this clock
+        if (cityGraph) cityGraph->setTrafficClock(currentSimHour * 60 + currentSimMinute);
+    }
     
     ~AIManager() = default;
     
@@ -46,6 +49,7 @@ public:
     void setTime(int hour, int minute) {
         currentSimHour = hour % 24;
         currentSimMinute = minute % 60;
+        if (cityGraph) cityGraph->setTrafficClock(currentSimHour * 60 + currentSimMinute);
     }
     
     void advanceTime(int minutes) {
@@ -54,6 +58,7 @@ public:
             currentSimMinute -= 60;
             currentSimHour = (currentSimHour + 1) % 24;
         }
+        if (cityGraph) cityGraph->advanceTrafficClock(minutes);
     }
     
     int getHour() const { return currentSimHour; }
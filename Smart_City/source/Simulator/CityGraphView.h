@@ -32,6 +32,7 @@ struct GraphNode2D {
     Point2D pos;
     string name;
     string type;
+    int typeID;            // FacilityType ID of type (compared in the per-frame loops)
     string sector;
     termgl::Color color;
     bool isCorner;
@@ -41,7 +42,7 @@ struct GraphNode2D {
     bool isEnd;
     int gridRow, gridCol;  // Position in sector's 5x5 grid (for corners)
 
-    GraphNode2D() : id(-1), lat(0), lon(0), pos(), name(""), type(""), sector(""),
+    GraphNode2D() : id(-1), lat(0), lon(0), pos(), name(""), type(""), typeID(FacilityType::ID_UNKNOWN), sector(""),
         color(termgl::Color::White()), isCorner(false), isOnPath(false),
         isVisited(false), isStart(false), isEnd(false), gridRow(-1), gridCol(-1) {
     }
@@ -120,6 +121,9 @@ struct CitizenRenderData {
         color(termgl::Color::White()), isSelected(false) {}
 };
 
+// Fraction of the canvas left empty on each side of the map
+constexpr double VIEW_PAD = 0.05;
+
 class GraphViewport {
 private:
     double minLat, maxLat, minLon, maxLon;
@@ -146,7 +150,9 @@ public:
     int getCanvasWidth() const { return canvasWidth; }
     int getCanvasHeight() const { return canvasHeight; }
 
-    Point2D geoToCanvas(double lat, double lon) const {
+private:
+    // Canvas size of the whole (unzoomed) map and its centring offsets inside the padded area
+    void getFit(double& scaleX, double& scaleY, double& offsetAdjustX, double& offsetAdjustY) const {
         // Calculate the real-world aspect ratio
         // At Islamabad's latitude (~33.7�), longitude degrees are shorter than latitude degrees
         // 1 degree lat ? 111 km, 1 degree lon ? 92 km at this latitude
@@ -161,21 +167,13 @@ public:
         double geoAspect = realWidth / realHeight;
         double canvasAspect = (double)canvasWidth / (double)canvasHeight;
         
-        // Normalize coordinates (0-1 range)
-        double normX = (lon - minLon) / lonRange;
-        double normY = (maxLat - lat) / latRange;  // Flip Y since screen Y increases downward
-        
-        // Apply zoom and pan
-        normX = (normX - 0.5) * zoom + 0.5 + offsetX;
-        normY = (normY - 0.5) * zoom + 0.5 + offsetY;
-        
         // Padding
-        double pad = 0.05;
-        double drawWidth = canvasWidth * (1.0 - 2 * pad);
-        double drawHeight = canvasHeight * (1.0 - 2 * pad);
+        double drawWidth = canvasWidth * (1.0 - 2 * VIEW_PAD);
+        double drawHeight = canvasHeight * (1.0 - 2 * VIEW_PAD);
         
         // Adjust for aspect ratio - fit the map while maintaining proportions
-        double scaleX, scaleY, offsetAdjustX = 0, offsetAdjustY = 0;
+        offsetAdjustX = 0;
+        offsetAdjustY = 0;
         
         if (geoAspect > canvasAspect) {
             // Map is wider than canvas - fit to width
@@ -188,13 +186,53 @@ public:
             scaleX = drawHeight * geoAspect;
             offsetAdjustX = (drawWidth - scaleX) / 2.0;
         }
+    }
+
+public:
+    Point2D geoToCanvas(double lat, double lon) const {
+        double scaleX, scaleY, offsetAdjustX, offsetAdjustY;
+        getFit(scaleX, scaleY, offsetAdjustX, offsetAdjustY);
+
+        // Normalize coordinates (0-1 range)
+        double normX = (lon - minLon) / (maxLon - minLon);
+        double normY = (maxLat - lat) / (maxLat - minLat);  // Flip Y since screen Y increases downward
         
-        double canvasX = pad * canvasWidth + offsetAdjustX + normX * scaleX;
-        double canvasY = pad * canvasHeight + offsetAdjustY + normY * scaleY;
+        // Apply zoom and pan
+        normX = (normX - 0.5) * zoom + 0.5 + offsetX;
+        normY = (normY - 0.5) * zoom + 0.5 + offsetY;
+        
+        double canvasX = VIEW_PAD * canvasWidth + offsetAdjustX + normX * scaleX;
+        double canvasY = VIEW_PAD * canvasHeight + offsetAdjustY + normY * scaleY;
 
         return Point2D(canvasX, canvasY);
     }
 
+    // Inverse of geoToCanvas
+    void canvasToGeo(Point2D p, double& lat, double& lon) const {
+        double scaleX, scaleY, offsetAdjustX, offsetAdjustY;
+        getFit(scaleX, scaleY, offsetAdjustX, offsetAdjustY);
+
+        double normX = (p.x - VIEW_PAD * canvasWidth - offsetAdjustX) / scaleX;
+        double normY = (p.y - VIEW_PAD * canvasHeight - offsetAdjustY) / scaleY;
+        normX = (normX - 0.5 - offsetX) / zoom + 0.5;
+        normY = (normY - 0.5 - offsetY) / zoom + 0.5;
+
+        lon = minLon + normX * (maxLon - minLon);
+        lat = maxLat - normY * (maxLat - minLat);
+    }
+
+    // Canvas pixels per km of ground (the fit keeps proportions, so both axes agree)
+    double getPixelsPerKm() const {
+        double scaleX, scaleY, offsetAdjustX, offsetAdjustY;
+        getFit(scaleX, scaleY, offsetAdjustX, offsetAdjustY);
+        return zoom * scaleX / ((maxLon - minLon) * KM_PER_LON_DEGREE);
+    }
+
+    // Ground radius covering a canvas radius, with a little slack for rounding
+    double pixelsToKm(double pixels) const {
+        return pixels / getPixelsPerKm() * 1.001 + 1e-9;
+    }
+
     void zoomIn() { zoom *= 1.1; if (zoom > 10.0) zoom = 10.0; }
     void zoomOut() { zoom /= 1.1; if (zoom < 0.1) zoom = 0.1; }
 
@@ -244,6 +282,10 @@ private:
     Vector<CitizenRenderData> citizenRenderList;
     GraphViewport viewport;
 
+    // Ground positions of the entries above, keyed by list index, for picking
+    SpatialGrid vehicleGrid;
+    SpatialGrid citizenGrid;
+
     // Assets
     termgl::Texture texSchool, texHospital, texPharmacy, texStop, texMall;
     termgl::Texture texMosque, texPark, texPolice, texFire, texLibrary;
@@ -432,9 +474,10 @@ public:
             gNode.lon = node->lon;
             gNode.pos = Point2D(0, 0);
             gNode.type = node->type;
+            gNode.typeID = node->typeID;
             gNode.sector = node->sector;
             gNode.color = getNodeColor(node->type);
-            gNode.isCorner = (node->type == "CORNER");
+            gNode.isCorner = (node->typeID == FacilityType::ID_CORNER);
             gNode.isOnPath = false;
             gNode.isVisited = false;
             gNode.isStart = false;
@@ -470,8 +513,8 @@ public:
                     gEdge.fromSector = node->sector;
                     gEdge.toSector = destNode->sector;
 
-                    bool fromIsCorner = (node->type == "CORNER");
-                    bool toIsCorner = (destNode->type == "CORNER");
+                    bool fromIsCorner = (node->typeID == FacilityType::ID_CORNER);
+                    bool toIsCorner = (destNode->typeID == FacilityType::ID_CORNER);
 
                     if (fromIsCorner && toIsCorner) {
                         // Both corners - classify based on grid position
@@ -520,6 +563,7 @@ public:
 
     void initializeTraffic() {
         trafficVehicles.clear();
+        vehicleGrid.clear();
         if (graphEdges.empty()) return;
 
         int numVehicles = std::min(80, (int)graphEdges.getSize() / 2);
@@ -543,6 +587,43 @@ public:
             vehicle.isBus = (rand() % 5 == 0);
             trafficVehicles.push_back(vehicle);
         }
+        indexVehicles();
+    }
+
+    // Ground position of a vehicle along its edge (false if its start node is not drawn).
+    // The canvas mapping is linear, so this lands exactly under the drawn sprite.
+    bool getVehicleGeoPosition(const TrafficVehicle& vehicle, double& lat, double& lon) const {
+        int idx1 = (vehicle.edgeFromID >= 0 && vehicle.edgeFromID < nodeIdToIndex.getSize()) ? 
+                   nodeIdToIndex[vehicle.edgeFromID] : -1;
+        int idx2 = (vehicle.edgeToID >= 0 && vehicle.edgeToID < nodeIdToIndex.getSize()) ? 
+                   nodeIdToIndex[vehicle.edgeToID] : -1;
+        if (idx1 < 0) return false;
+
+        const GraphNode2D& n1 = graphNodes[idx1];
+        lat = n1.lat;
+        lon = n1.lon;
+        if (idx2 >= 0) {
+            const GraphNode2D& n2 = graphNodes[idx2];
+            double t = vehicle.progress;
+            if (t > 1.0) t = 1.0;
+            if (t < 0.0) t = 0.0;
+            lat += (n2.lat - n1.lat) * t;
+            lon += (n2.lon - n1.lon) * t;
+        }
+        return true;
+    }
+
+    void indexVehicle(int i) {
+        double lat, lon;
+        if (getVehicleGeoPosition(trafficVehicles[i], lat, lon)) vehicleGrid.insert(i, lat, lon);
+        else vehicleGrid.remove(i);
+    }
+
+    void indexVehicles() {
+        vehicleGrid.clear();
+        for (int i = 0; i < trafficVehicles.getSize(); i++) {
+            indexVehicle(i);
+        }
     }
 
     // ==================== PHASE 5: REAL VEHICLE SYNC ====================
@@ -550,6 +631,7 @@ public:
         if (!city) return;
         
         trafficVehicles.clear();
+        vehicleGrid.clear();
         TransportManager* tm = city->getTransportManager();
         if (!tm) return;
         
@@ -631,11 +713,13 @@ public:
             
             trafficVehicles.push_back(tv);
         }
+        indexVehicles();
     }
     
     // ==================== PHASE 5: CITIZEN SYNC ====================
     void syncCitizens() {
         citizenRenderList.clear();
+        citizenGrid.clear();
         if (!city || !showCitizens) return;
         
         PopulationManager* pm = city->getPopulationManager();
@@ -670,6 +754,7 @@ public:
                 crd.color = termgl::Color::Green();
             }
             
+            citizenGrid.insert(citizenRenderList.getSize(), crd.lat, crd.lon);
             citizenRenderList.push_back(crd);
         }
     }
@@ -1034,7 +1119,7 @@ public:
 
         for (int i = 0; i < graphNodes.getSize(); i++) {
             const GraphNode2D& node = graphNodes[i];
-            if (node.type != "HOUSE") continue;
+            if (node.typeID != FacilityType::ID_HOUSE) continue;
             if (!viewport.isVisible(node.pos)) continue;
 
             window.fillCircle((int)node.pos.x, (int)node.pos.y, houseRadius, 
@@ -1066,21 +1151,24 @@ public:
             const GraphNode2D& node = graphNodes[i];
 
             if (!viewport.isVisible(node.pos)) continue;
-            if (node.isCorner || node.type == "HOUSE") continue;
+            if (node.isCorner || node.typeID == FacilityType::ID_HOUSE) continue;
             if (dijkstraPath.getSize() > 0 && !node.isOnPath && !node.isStart && !node.isEnd) continue;
 
             termgl::Sprite* s = nullptr;
-            if (node.type == "SCHOOL") s = &sprSchool;
-            else if (node.type == "HOSPITAL") s = &sprHospital;
-            else if (node.type == "PHARMACY") s = &sprPharmacy;
-            else if (node.type == "STOP") s = &sprStop;
-            else if (node.type == "MALL") s = &sprMall;
-            else if (node.type == "MOSQUE") s = &sprMosque;
-            else if (node.type == "PARK") s = &sprPark;
-            else if (node.type == "POLICE_STATION") s = &sprPolice;
-            else if (node.type == "FIRE_STATION") s = &sprFire;
-            else if (node.type == "LIBRARY") s = &sprLibrary;
-            else if (node.type == "RESTAURANT") s = &sprRestaurant;
+            switch (node.typeID) {
+            case FacilityType::ID_SCHOOL: s = &sprSchool; break;
+            case FacilityType::ID_HOSPITAL: s = &sprHospital; break;
+            case FacilityType::ID_PHARMACY: s = &sprPharmacy; break;
+            case FacilityType::ID_STOP: s = &sprStop; break;
+            case FacilityType::ID_MALL: s = &sprMall; break;
+            case FacilityType::ID_MOSQUE: s = &sprMosque; break;
+            case FacilityType::ID_PARK: s = &sprPark; break;
+            case FacilityType::ID_POLICE_STATION: s = &sprPolice; break;
+            case FacilityType::ID_FIRE_STATION: s = &sprFire; break;
+            case FacilityType::ID_LIBRARY: s = &sprLibrary; break;
+            case FacilityType::ID_RESTAURANT: s = &sprRestaurant; break;
+            default: break;
+            }
 
             bool spriteDrawn = false;
             float targetSize = (node.isStart || node.isEnd) ? spriteSize * 1.5f : spriteSize;
@@ -1271,19 +1359,34 @@ public:
 
         double minDist = 15.0 * viewport.getScaleFactor();
 
-        for (int i = 0; i < graphNodes.getSize(); i++) {
+        // Only nodes within minDist pixels of the cursor can win; fetch those from the graph's grid
+        Vector<int> nearby;
+        if (city) {
+            double lat, lon;
+            viewport.canvasToGeo(Point2D(mx, my), lat, lon);
+            nearby = city->getCityGraph()->findNodesInRadius(lat, lon, viewport.pixelsToKm(minDist));
+        }
+
+        int bestIndex = -1;
+        for (int k = 0; k < nearby.getSize(); k++) {
+            int nodeID = nearby[k];
+            int i = (nodeID < nodeIdToIndex.getSize()) ? nodeIdToIndex[nodeID] : -1;
+            if (i < 0) continue;
+
             const GraphNode2D& node = graphNodes[i];
             if (!viewport.isVisible(node.pos)) continue;
             if (node.isCorner && !showCorners) continue;
-            if (node.type == "HOUSE" && !showHouses) continue;
+            if (node.typeID == FacilityType::ID_HOUSE && !showHouses) continue;
 
             double dx = node.pos.x - mx;
             double dy = node.pos.y - my;
             if (std::abs(dx) > 30 || std::abs(dy) > 30) continue;
 
+            // Same winner as a full scan in list order: closest, then lowest index
             double dist = std::sqrt(dx * dx + dy * dy);
-            if (dist < minDist) {
+            if (dist < minDist || (dist == minDist && bestIndex != -1 && i < bestIndex)) {
                 minDist = dist;
+                bestIndex = i;
                 hoveredNodeID = node.id;
             }
         }
@@ -1361,15 +1464,25 @@ public:
                     }
                 }
             }
+            indexVehicle(i);
         }
     }
 
     // ==================== HIT TESTING FOR VEHICLES/CITIZENS ====================
+    // Candidates come from the position grids; the pixel test and the lowest-index winner
+    // are unchanged from a scan of the whole list
     int hitTestVehicle(int mx, int my) {
         double scale = viewport.getScaleFactor();
         int hitRadius = (int)(10 * scale);
-        
-        for (int i = 0; i < trafficVehicles.getSize(); i++) {
+
+        double lat, lon;
+        viewport.canvasToGeo(Point2D(mx, my), lat, lon);
+        Vector<int> nearby = vehicleGrid.findInRadius(lat, lon, viewport.pixelsToKm(hitRadius));
+
+        int hit = -1;
+        for (int k = 0; k < nearby.getSize(); k++) {
+            int i = nearby[k];
+            if (i >= trafficVehicles.getSize() || (hit != -1 && i > hit)) continue;
             const TrafficVehicle& vehicle = trafficVehicles[i];
             
             int idx1 = (vehicle.edgeFromID >= 0 && vehicle.edgeFromID < nodeIdToIndex.getSize()) ? 
@@ -1395,27 +1508,34 @@ public:
             double dx = pos.x - mx;
             double dy = pos.y - my;
             if (dx * dx + dy * dy < hitRadius * hitRadius) {
-                return i;
+                hit = i;
             }
         }
-        return -1;
+        return hit;
     }
     
     int hitTestCitizen(int mx, int my) {
         double scale = viewport.getScaleFactor();
         int hitRadius = (int)(8 * scale);
-        
-        for (int i = 0; i < citizenRenderList.getSize(); i++) {
+
+        double lat, lon;
+        viewport.canvasToGeo(Point2D(mx, my), lat, lon);
+        Vector<int> nearby = citizenGrid.findInRadius(lat, lon, viewport.pixelsToKm(hitRadius));
+
+        int hit = -1;
+        for (int k = 0; k < nearby.getSize(); k++) {
+            int i = nearby[k];
+            if (i >= citizenRenderList.getSize() || (hit != -1 && i > hit)) continue;
             const CitizenRenderData& crd = citizenRenderList[i];
             Point2D pos = viewport.geoToCanvas(crd.lat, crd.lon);
             
             double dx = pos.x - mx;
             double dy = pos.y - my;
             if (dx * dx + dy * dy < hitRadius * hitRadius) {
-                return i;
+                hit = i;
             }
         }
-        return -1;
+        return hit;
     }
 
     // ========================================================================
@@ -642,7 +642,7 @@ inline CityManagement::RouteInfo CityManagement::calculateRoute(const string& st
     CityNode* startNode = graph->getNode(startID);
     CityNode* endNode = graph->getNode(endID);
 
-    info.path = graph->findShortestPath(startID, endID, info.distance);
+    info.path = graph->findShortestPath(startID, endID, info.distance, RouteSearchMode::HIERARCHY);
     info.stopCount = info.path.getSize();
     info.startName = startNode ? startNode->name : "";
     info.endName = endNode ? endNode->name : "";
@@ -662,7 +662,7 @@ inline CityManagement::RouteInfo CityManagement::calculateRouteByName(const stri
 
     if (startID == -1 || endID == -1) return info;
 
-    info.path = graph->findShortestPath(startID, endID, info.distance);
+    info.path = graph->findShortestPath(startID, endID, info.distance, RouteSearchMode::HIERARCHY);
     info.stopCount = info.path.getSize();
     info.startName = startName;
     info.endName = endName;
@@ -942,6 +942,7 @@ inline bool CityManagement::addRoad(int node1ID, int node2ID) {
 
     CityGraph* graph = city->getCityGraph();
     graph->addRoad(node1ID, node2ID);
+    city->refreshSectorDistances();
     return true;
 }
 
@@ -988,7 +989,7 @@ inline Vector<CityNode*> CityManagement::getAllStops() {
     CityGraph* graph = city->getCityGraph();
     for (int i = 0; i < graph->getNodeCount(); i++) {
         CityNode* node = graph->getNode(i);
-        if (node && node->type == "STOP") {
+        if (node && node->typeID == FacilityType::ID_STOP) {
             stops.push_back(node);
         }
     }
@@ -996,17 +997,8 @@ inline Vector<CityNode*> CityManagement::getAllStops() {
 }
 
 inline Vector<CityNode*> CityManagement::getStopsInSector(const string& sector) {
-    Vector<CityNode*> stops;
-    if (!city || !city->isInitialized()) return stops;
-
-    CityGraph* graph = city->getCityGraph();
-    for (int i = 0; i < graph->getNodeCount(); i++) {
-        CityNode* node = graph->getNode(i);
-        if (node && node->type == "STOP" && node->sector == sector) {
-            stops.push_back(node);
-        }
-    }
-    return stops;
+    if (!city || !city->isInitialized()) return Vector<CityNode*>();
+    return city->getStopsInSector(sector);
 }
 
 inline CityManagement::SchoolDetails CityManagement::getSchoolDetails(const string& schoolID) {
@@ -223,6 +223,15 @@ public:
         }
     }
     
+    // Home sector plus an explicit list, e.g. the nearest sectors by road
+    void setPrioritySectors(const string& sector, const Vector<string>& nearby) {
+        prioritySectors.clear();
+        prioritySectors.push_back(sector);
+        for (int i = 0; i < nearby.getSize(); ++i) {
+            if (nearby[i] != sector) prioritySectors.push_back(nearby[i]);
+        }
+    }
+    
     bool isSectorInPriority(const string& sector) const {
         for (int i = 0; i < prioritySectors.getSize(); ++i) {
             if (prioritySectors[i] == sector) return true;
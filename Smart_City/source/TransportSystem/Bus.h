@@ -52,7 +52,10 @@ public:
           startStopID(""), endStopID(""),
           waitingQueue(100), onboardPassengers(),
           departureIntervalMinutes(15), isRoundTrip(true),
-          totalPassengersServed(0), totalFareCollected(0.0), tripsCompleted(0) {}
+          totalPassengersServed(0), totalFareCollected(0.0), tripsCompleted(0) {
+        // Refilled at every stop; keep the storage while riders get off
+        onboardPassengers.setAutoShrink(false);
+    }
     
     Bus(const string& busNo, const string& company, const string& currentStop)
         : Vehicle(busNo, VehicleType::BUS, 50),
@@ -62,6 +65,7 @@ public:
           departureIntervalMinutes(15), isRoundTrip(true),
           totalPassengersServed(0), totalFareCollected(0.0), tripsCompleted(0) {
         currentStopName = currentStop;
+        onboardPassengers.setAutoShrink(false);
     }
     
     Bus(const Bus& other) 
@@ -138,29 +142,40 @@ public:
         return waitingQueue.enqueue(p);
     }
     
+    bool addWaitingPassenger(Passenger&& p) {
+        return waitingQueue.enqueue(std::move(p));
+    }
+    
+    // Waiting riders are drained straight onto the bus, one free seat each; those not
+    // riding forward along the route are dropped again and the next batch is drained
     int boardWaitingPassengers() {
         int boarded = 0;
+        int currentPos = getRoutePosition(currentNodeID);
         
         while (!waitingQueue.empty() && !isFull()) {
-            Passenger p = waitingQueue.dequeue();
-            
-            int currentPos = getRoutePosition(currentNodeID);
-            int destPos = getRoutePosition(p.destinationStopID);
+            int first = onboardPassengers.getSize();
+            waitingQueue.drain(getAvailableCapacity(), onboardPassengers);
             
-            if (destPos > currentPos) {
-                onboardPassengers.push_back(p);
-                ++currentOccupancy;
-                totalFareCollected += p.fare;
-                ++boarded;
+            int kept = first;
+            for (int i = first; i < onboardPassengers.getSize(); ++i) {
+                if (getRoutePosition(onboardPassengers[i].destinationStopID) > currentPos) {
+                    totalFareCollected += onboardPassengers[i].fare;
+                    if (kept != i) onboardPassengers[kept] = std::move(onboardPassengers[i]);
+                    ++kept;
+                    ++currentOccupancy;
+                    ++boarded;
+                }
             }
+            onboardPassengers.resize(kept);
         }
         
         return boarded;
     }
     
+    // Riders staying on are moved up in place over the ones getting off
     int alightPassengers() {
         int alighted = 0;
-        Vector<Passenger> remaining;
+        int kept = 0;
         
         for (int i = 0; i < onboardPassengers.getSize(); ++i) {
             if (onboardPassengers[i].destinationStopID == currentNodeID) {
@@ -168,11 +183,12 @@ public:
                 ++totalPassengersServed;
                 --currentOccupancy;
             } else {
-                remaining.push_back(onboardPassengers[i]);
+                if (kept != i) onboardPassengers[kept] = std::move(onboardPassengers[i]);
+                ++kept;
             }
         }
         
-        onboardPassengers = remaining;
+        onboardPassengers.resize(kept);
         return alighted;
     }
     
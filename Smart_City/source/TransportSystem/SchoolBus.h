@@ -103,6 +103,8 @@ public:
           totalStudentsTransported(0), tripsCompleted(0), totalDistanceCovered(0.0),
           homePickupsCompleted(0), schoolPickupsCompleted(0) {
         speed = 35.0; 
+        // Refilled at every stop; keep the storage while students get off
+        onboardStudents.setAutoShrink(false);
     }
     
     SchoolBus(const string& id, const string& schoolID, int schoolNodeID, const string& sector)
@@ -118,6 +120,7 @@ public:
         homeSector = sector;
         homeNodeID = schoolNodeID;
         speed = 35.0;
+        onboardStudents.setAutoShrink(false);
         
         setPrioritySectors(sector);
         
@@ -219,6 +222,15 @@ public:
         }
     }
     
+    // Home sector plus an explicit list, e.g. the nearest sectors by road
+    void setPrioritySectors(const string& homeSector, const Vector<string>& nearby) {
+        prioritySectors.clear();
+        prioritySectors.push_back(homeSector);
+        for (int i = 0; i < nearby.getSize(); ++i) {
+            if (nearby[i] != homeSector) prioritySectors.push_back(nearby[i]);
+        }
+    }
+    
     bool isSectorInPriority(const string& sector) const {
         for (int i = 0; i < prioritySectors.getSize(); ++i) {
             if (prioritySectors[i] == sector) return true;
@@ -301,24 +313,40 @@ public:
         return true;
     }
     
+    // Boards students from a pickup point's line until the bus is full; returns how many
+    int boardStudentsFrom(CircularQueue<StudentPassenger>& line) {
+        int boarded = line.drain(getAvailableCapacity(), onboardStudents);
+        currentOccupancy += boarded;
+        return boarded;
+    }
+    
+    // Waiting students are drained straight onto the bus, one free seat each; those who do
+    // not belong here are dropped again and the next batch is drained
     int boardStudentsAtLocation(int locationNodeID) {
         int boarded = 0;
         setSchoolBusStatus(SchoolBusStatus::LOADING_STUDENTS);
         
         while (!waitingStudents.empty() && !isFull()) {
-            StudentPassenger student = waitingStudents.dequeue();
+            int first = onboardStudents.getSize();
+            waitingStudents.drain(getAvailableCapacity(), onboardStudents);
             
-            if (student.pickupNodeID == locationNodeID || student.pickupNodeID == -1) {
-                onboardStudents.push_back(student);
-                ++currentOccupancy;
-                ++boarded;
-                
-                if (student.isHomePickup) {
-                    ++homePickupsCompleted;
-                } else {
-                    ++schoolPickupsCompleted;
+            int kept = first;
+            for (int i = first; i < onboardStudents.getSize(); ++i) {
+                StudentPassenger& student = onboardStudents[i];
+                if (student.pickupNodeID == locationNodeID || student.pickupNodeID == -1) {
+                    if (student.isHomePickup) {
+                        ++homePickupsCompleted;
+                    } else {
+                        ++schoolPickupsCompleted;
+                    }
+                    
+                    if (kept != i) onboardStudents[kept] = std::move(student);
+                    ++kept;
+                    ++currentOccupancy;
+                    ++boarded;
                 }
             }
+            onboardStudents.resize(kept);
         }
         
         return boarded;
@@ -335,13 +363,19 @@ public:
         setSchoolBusStatus(SchoolBusStatus::LOADING_STUDENTS);
         
         while (!waitingStudents.empty() && !isFull()) {
-            StudentPassenger student = waitingStudents.dequeue();
+            int first = onboardStudents.getSize();
+            waitingStudents.drain(getAvailableCapacity(), onboardStudents);
             
-            if (isOnRoute(student.dropoffNodeID)) {
-                onboardStudents.push_back(student);
-                ++currentOccupancy;
-                ++boarded;
+            int kept = first;
+            for (int i = first; i < onboardStudents.getSize(); ++i) {
+                if (isOnRoute(onboardStudents[i].dropoffNodeID)) {
+                    if (kept != i) onboardStudents[kept] = std::move(onboardStudents[i]);
+                    ++kept;
+                    ++currentOccupancy;
+                    ++boarded;
+                }
             }
+            onboardStudents.resize(kept);
         }
         
         return boarded;
@@ -351,7 +385,7 @@ public:
         if (currentSchoolID.empty() && currentNodeID == -1) return 0;
         
         int dropped = 0;
-        Vector<StudentPassenger> remaining;
+        int kept = 0;
         
         setSchoolBusStatus(SchoolBusStatus::UNLOADING);
         
@@ -370,11 +404,13 @@ public:
                 ++totalStudentsTransported;
                 --currentOccupancy;
             } else {
-                remaining.push_back(onboardStudents[i]);
+                // Students staying on are moved up in place over the ones getting off
+                if (kept != i) onboardStudents[kept] = std::move(onboardStudents[i]);
+                ++kept;
             }
         }
         
-        onboardStudents = remaining;
+        onboardStudents.resize(kept);
         return dropped;
     }
     
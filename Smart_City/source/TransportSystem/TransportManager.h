@@ -12,6 +12,9 @@
 using std::string;
 using std::ifstream;
 
+// Sectors besides its home sector that an ambulance or school bus gives priority to
+constexpr int PRIORITY_SECTOR_COUNT = 4;
+
 struct BusStopQueue {
     int stopNodeID;
     string stopName;
@@ -80,7 +83,7 @@ private:
     HashTable<string, Vector<Ambulance*>> hospitalAmbulanceLookup;
     HashTable<string, Vector<Ambulance*>> sectorAmbulanceLookup;
 
-    PriorityQueue<PatientTransfer> transferQueue;
+    HandlePriorityQueue<PatientTransfer> transferQueue;   // Keyed by EmergencyPriority value: CRITICAL first
     Vector<PatientTransfer> activeTransfers;
 
     // ========== RICKSHAW MANAGEMENT ==========
@@ -88,7 +91,12 @@ private:
     HashTable<string, Vector<Vehicle*>> sectorRickshawLookup;
     int rickshawIDCounter;
 
+    // Vehicle trips routed so far per (from, to) node pair: the n-th trip of a pair is dealt
+    // alternative n, so a pair's first trip always takes the shortest route
+    HashTable<long long, int> pairTrips;
+
     HashTable<int, BusStopQueue*> stopQueues;
+    Vector<Passenger> arrivingPassengers;   // processBusArrival scratch, kept between stops
 
     int simulationStep;
 
@@ -155,7 +163,10 @@ public:
     Vector<Ambulance*> getAmbulancesByHospital(const string& hospitalID) const;
     Vector<Ambulance*> getAmbulancesBySector(const string& sector) const;
     Vector<Ambulance*> getAvailableAmbulances() const;
-    Ambulance* findAmbulanceForTransfer(const string& sourceSector, const string& destSector) const;
+    // With a known pickup node, the available ambulance closest to it by road; otherwise
+    // (or if none can reach it) the first match by sector priority and adjacency
+    Ambulance* findAmbulanceForTransfer(const string& sourceSector, const string& destSector,
+        int sourceNodeID = -1) const;
 
     int getAmbulanceCount() const { return ambulances.getSize(); }
     Ambulance* getAmbulance(int index) const;
@@ -209,6 +220,15 @@ public:
     void processSchoolBusPickup(SchoolBus* sb, int pickupNodeID);
     void processSchoolBusSchoolArrival(SchoolBus* sb, const string& schoolID, int schoolNodeID);
 
+    // ==================== DYNAMIC ROUTING ====================
+    // Sends the vehicle to goalNodeID over an incremental route: whenever traffic changes the
+    // road ahead, the remaining route is repaired at the next node the vehicle reaches
+    // (or while it waits to enter a full road). Returns false if the goal is unreachable.
+    // With spread set, repeated trips between the same two nodes are dealt the alternative
+    // routes (CityGraph::findSpreadRoute on the dynamic metric); a vehicle given one that is
+    // not the shortest drives it as is.
+    bool routeVehicleTo(Vehicle* vehicle, int goalNodeID, bool spread = false);
+
     TransportStats getStats() const;
 
     // ==================== CSV LOADING ====================
@@ -217,12 +237,37 @@ public:
     bool loadAmbulancesFromCSV(const string& filename, bool hasHeader = true);
     bool loadSchoolBusesFromCSV(const string& filename, bool hasHeader = true);
 
+    // Sectors sharing an edge with sector (west, east, north, south), from SECTOR_TOPOLOGY
     static Vector<string> getAdjacentSectors(const string& sector);
     static bool areSectorsAdjacent(const string& sector1, const string& sector2);
 
+    // ==================== SECTOR DISTANCES ====================
+    // Every other sector, nearest by road first (from CityGraph's sector distance table).
+    // Falls back to the bordering sectors when there is no graph; empty for an unknown sector.
+    Vector<string> getSectorsByDistance(const string& sector) const;
+    double getSectorDistance(const string& fromSector, const string& toSector) const;
+    // Re-derives every ambulance's and school bus's priority sectors as its home sector
+    // plus the PRIORITY_SECTOR_COUNT nearest sectors by road
+    void refreshPrioritySectors();
+
 private:
+    // SECTOR_GRID indices behind getSectorsByDistance, read in place (count = 0 if unknown)
+    const int* getNearbySectors(int sectorIndex, int& count) const;
     string trim(const string& s) const;
     Vector<string> parseRoute(const string& routeStr) const;
+
+    // Edge handle of the road the vehicle is on; re-resolved only when its node pair changed
+    int currentEdgeOf(Vehicle* vehicle);
+
+    // Nearest-neighbour visiting order over the pickups, starting at startNodeID
+    Vector<int> orderPickupsByDistance(int startNodeID, const Vector<int>& pickups) const;
+
+    // Spread key of the next trip between the two nodes (the number routed before it)
+    int nextSpreadKey(int fromNodeID, int toNodeID);
+
+    // Called with the vehicle standing on a node: swaps in the repaired route if it changed
+    void refreshVehicleRoute(Vehicle* vehicle);
+    void releaseVehicleRoute(Vehicle* vehicle);
 };
 
 // ============================================================================
@@ -236,10 +281,11 @@ inline TransportManager::TransportManager()
     ambulances(), ambulanceLookup(53),
     hospitalAmbulanceLookup(53), sectorAmbulanceLookup(53),
     transferQueue(), activeTransfers(),
-    rickshaws(), sectorRickshawLookup(53), rickshawIDCounter(0),
-    stopQueues(201),
+    rickshaws(), sectorRickshawLookup(53), rickshawIDCounter(0), pairTrips(),
+    stopQueues(201), arrivingPassengers(),
     simulationStep(0), simulationRunning(false),
     totalTransferRequests(0), transferIDCounter(1000) {
+    arrivingPassengers.setAutoShrink(false);
 }
 
 inline TransportManager::~TransportManager() {
@@ -251,29 +297,69 @@ inline TransportManager::~TransportManager() {
 
 inline Vector<string> TransportManager::getAdjacentSectors(const string& sector) {
     Vector<string> adjacent;
-    if (sector.empty() || sector.length() < 3) return adjacent;
-    char series = sector[0];
-    int number = 0;
-    string numStr = "";
-    for (int i = 2; i < (int)sector.length(); ++i) { numStr += sector[i]; }
-    try { if (!numStr.empty()) number = std::stoi(numStr); }
-    catch (...) { return adjacent; }
-    if (number > 6) adjacent.push_back(string(1, series) + "-" + std::to_string(number - 1));
-    if (number < 12) adjacent.push_back(string(1, series) + "-" + std::to_string(number + 1));
-    if (series > 'E') adjacent.push_back(string(1, series - 1) + "-" + std::to_string(number));
-    if (series < 'I') adjacent.push_back(string(1, series + 1) + "-" + std::to_string(number));
+    int idx = GeometryUtils::getSectorIndex(sector);
+    if (idx == -1) return adjacent;
+    for (int k = 0; k < SECTOR_TOPOLOGY.borderingCount[idx]; ++k) {
+        adjacent.push_back(SECTOR_GRID[SECTOR_TOPOLOGY.bordering[idx][k]].name);
+    }
     return adjacent;
 }
 
 inline bool TransportManager::areSectorsAdjacent(const string& sector1, const string& sector2) {
     if (sector1 == sector2) return true;
-    Vector<string> adjacent = getAdjacentSectors(sector1);
-    for (int i = 0; i < adjacent.getSize(); ++i) {
-        if (adjacent[i] == sector2) return true;
+    int from = GeometryUtils::getSectorIndex(sector1);
+    int to = GeometryUtils::getSectorIndex(sector2);
+    if (from == -1 || to == -1) return false;
+    for (int k = 0; k < SECTOR_TOPOLOGY.borderingCount[from]; ++k) {
+        if (SECTOR_TOPOLOGY.bordering[from][k] == to) return true;
     }
     return false;
 }
 
+// ==================== SECTOR DISTANCES ====================
+
+inline const int* TransportManager::getNearbySectors(int sectorIndex, int& count) const {
+    count = 0;
+    if (sectorIndex < 0 || sectorIndex >= SECTOR_COUNT) return nullptr;
+    if (cityGraph) return cityGraph->getSectorsByDistance(sectorIndex, count);
+    count = SECTOR_TOPOLOGY.borderingCount[sectorIndex];
+    return SECTOR_TOPOLOGY.bordering[sectorIndex];
+}
+
+inline Vector<string> TransportManager::getSectorsByDistance(const string& sector) const {
+    Vector<string> result;
+    int count = 0;
+    const int* nearby = getNearbySectors(GeometryUtils::getSectorIndex(sector), count);
+    for (int i = 0; i < count; ++i) {
+        result.push_back(SECTOR_GRID[nearby[i]].name);
+    }
+    return result;
+}
+
+inline double TransportManager::getSectorDistance(const string& fromSector, const string& toSector) const {
+    if (!cityGraph) return INF;
+    return cityGraph->getSectorDistance(fromSector, toSector);
+}
+
+inline void TransportManager::refreshPrioritySectors() {
+    if (!cityGraph) return;
+
+    for (int i = 0; i < ambulances.getSize(); ++i) {
+        string home = ambulances[i]->getHomeSector();
+        if (GeometryUtils::getSectorIndex(home) == -1) continue;
+        Vector<string> nearest = getSectorsByDistance(home);
+        while (nearest.getSize() > PRIORITY_SECTOR_COUNT) nearest.pop_back();
+        ambulances[i]->setPrioritySectors(home, nearest);
+    }
+    for (int i = 0; i < schoolBuses.getSize(); ++i) {
+        string home = schoolBuses[i]->getHomeSector();
+        if (GeometryUtils::getSectorIndex(home) == -1) continue;
+        Vector<string> nearest = getSectorsByDistance(home);
+        while (nearest.getSize() > PRIORITY_SECTOR_COUNT) nearest.pop_back();
+        schoolBuses[i]->setPrioritySectors(home, nearest);
+    }
+}
+
 // ==================== BUS MANAGEMENT ====================
 
 inline Bus* TransportManager::createBus(const string& busNo, const string& company, const string& currentStop) {
@@ -454,6 +540,38 @@ inline Vector<int> TransportManager::getPickupPointsInSector(const string& secto
     return nodes ? *nodes : Vector<int>();
 }
 
+// One distance matrix (start + every pickup) x pickups, then always drive to the closest
+// unvisited pickup. Pickups that cannot be reached keep their original order at the end.
+inline Vector<int> TransportManager::orderPickupsByDistance(int startNodeID, const Vector<int>& pickups) const {
+    if (!cityGraph || pickups.getSize() < 2) return pickups;
+
+    int count = pickups.getSize();
+    Vector<int> origins;
+    origins.push_back(startNodeID);
+    for (int i = 0; i < count; ++i) origins.push_back(pickups[i]);
+    Vector<double> distances = cityGraph->distanceMatrix(origins, pickups);
+
+    Vector<bool> visited;
+    visited.resize(count, false);
+    Vector<int> order;
+    int row = 0;    // Origin row: 0 is the start, i + 1 is pickups[i]
+    for (int step = 0; step < count; ++step) {
+        int next = -1;
+        for (int j = 0; j < count; ++j) {
+            if (visited[j] || distances[row * count + j] >= INF) continue;
+            if (next == -1 || distances[row * count + j] < distances[row * count + next]) next = j;
+        }
+        if (next == -1) break;
+        visited[next] = true;
+        order.push_back(pickups[next]);
+        row = next + 1;
+    }
+    for (int j = 0; j < count; ++j) {
+        if (!visited[j]) order.push_back(pickups[j]);
+    }
+    return order;
+}
+
 inline bool TransportManager::setupSchoolBusHomeRoute(const string& busID, const Vector<int>& pickupNodes,
     int schoolNodeID, const string& schoolID) {
     SchoolBus* sb = findSchoolBusByID(busID);
@@ -537,27 +655,52 @@ inline Vector<Ambulance*> TransportManager::getAvailableAmbulances() const {
 }
 
 inline Ambulance* TransportManager::findAmbulanceForTransfer(const string& sourceSector,
-    const string& destSector) const {
-    Vector<Ambulance*> sourceAmbs = getAmbulancesBySector(sourceSector);
-    for (int i = 0; i < sourceAmbs.getSize(); ++i) {
-        if (sourceAmbs[i]->isAvailable() && sourceAmbs[i]->isSectorInPriority(destSector)) {
-            return sourceAmbs[i];
+    const string& destSector, int sourceNodeID) const {
+    if (cityGraph && sourceNodeID != -1) {
+        Vector<Ambulance*> available = getAvailableAmbulances();
+        Vector<int> positions;
+        for (int i = 0; i < available.getSize(); ++i) {
+            positions.push_back(available[i]->getCurrentNodeID());
+        }
+        Vector<int> pickup;
+        pickup.push_back(sourceNodeID);
+        Vector<double> distances = cityGraph->distanceMatrix(positions, pickup);
+
+        Ambulance* nearest = nullptr;
+        double minDistance = INF;
+        for (int i = 0; i < available.getSize(); ++i) {
+            if (distances[i] < minDistance) {
+                minDistance = distances[i];
+                nearest = available[i];
+            }
+        }
+        if (nearest) return nearest;
+    }
+
+    // Sector lists are read in place from the lookup table, nothing is copied
+    const Vector<Ambulance*>* sourceAmbs = sectorAmbulanceLookup.get(sourceSector);
+    for (int i = 0; sourceAmbs && i < sourceAmbs->getSize(); ++i) {
+        Ambulance* amb = (*sourceAmbs)[i];
+        if (amb->isAvailable() && amb->isSectorInPriority(destSector)) {
+            return amb;
         }
     }
 
-    Vector<Ambulance*> destAmbs = getAmbulancesBySector(destSector);
-    for (int i = 0; i < destAmbs.getSize(); ++i) {
-        if (destAmbs[i]->isAvailable() && destAmbs[i]->isSectorInPriority(sourceSector)) {
-            return destAmbs[i];
+    const Vector<Ambulance*>* destAmbs = sectorAmbulanceLookup.get(destSector);
+    for (int i = 0; destAmbs && i < destAmbs->getSize(); ++i) {
+        Ambulance* amb = (*destAmbs)[i];
+        if (amb->isAvailable() && amb->isSectorInPriority(sourceSector)) {
+            return amb;
         }
     }
 
-    Vector<string> adjacentToSource = getAdjacentSectors(sourceSector);
-    for (int i = 0; i < adjacentToSource.getSize(); ++i) {
-        Vector<Ambulance*> adjAmbs = getAmbulancesBySector(adjacentToSource[i]);
-        for (int j = 0; j < adjAmbs.getSize(); ++j) {
-            if (adjAmbs[j]->isAvailable()) {
-                return adjAmbs[j];
+    int nearbyCount = 0;
+    const int* nearby = getNearbySectors(GeometryUtils::getSectorIndex(sourceSector), nearbyCount);
+    for (int i = 0; i < nearbyCount; ++i) {
+        const Vector<Ambulance*>* adjAmbs = sectorAmbulanceLookup.get(SECTOR_GRID[nearby[i]].name);
+        for (int j = 0; adjAmbs && j < adjAmbs->getSize(); ++j) {
+            if ((*adjAmbs)[j]->isAvailable()) {
+                return (*adjAmbs)[j];
             }
         }
     }
@@ -630,10 +773,11 @@ inline Vehicle* TransportManager::findAvailableRickshaw(int nearNodeID, const st
         }
     }
 
-    // Check adjacent sectors
-    Vector<string> adjacent = getAdjacentSectors(sector);
-    for (int i = 0; i < adjacent.getSize(); ++i) {
-        Vector<Vehicle*>* adjList = sectorRickshawLookup.get(adjacent[i]);
+    // Then the other sectors, nearest by road first
+    int nearbyCount = 0;
+    const int* nearby = getNearbySectors(GeometryUtils::getSectorIndex(sector), nearbyCount);
+    for (int i = 0; i < nearbyCount; ++i) {
+        Vector<Vehicle*>* adjList = sectorRickshawLookup.get(SECTOR_GRID[nearby[i]].name);
         if (adjList) {
             for (int j = 0; j < adjList->getSize(); ++j) {
                 Vehicle* rick = (*adjList)[j];
@@ -658,22 +802,17 @@ inline bool TransportManager::dispatchRickshaw(Vehicle* rickshaw, int pickupNode
     if (!rickshaw || !cityGraph) return false;
     if (rickshaw->getStatus() != VehicleStatus::IDLE) return false;
 
-    // Calculate route from current position to pickup
-    double pickupDist = 0;
-    Vector<int> pickupRoute = cityGraph->findShortestPath(rickshaw->getCurrentNodeID(), pickupNodeID, pickupDist);
-
-    if (pickupRoute.getSize() == 0) return false;
+    // Route from current position to pickup. Repeated dispatches along the same pair are dealt
+    // out over the alternative routes so they do not all queue on one road.
+    if (!routeVehicleTo(rickshaw, pickupNodeID, true)) return false;
 
     // Store destination for later
     rickshaw->setStatus(VehicleStatus::PICKING_UP);
-    rickshaw->setRouteSimple(pickupRoute, pickupDist);
     rickshaw->addPassenger(passengerCNIC);
 
     // Try to enter the first edge
-    if (pickupRoute.getSize() > 1) {
-        int currentNode = pickupRoute[0];
-        int nextNode = pickupRoute[1];
-        if (!cityGraph->tryEnterEdge(currentNode, nextNode)) {
+    if (rickshaw->getRouteLength() > 1) {
+        if (!cityGraph->tryEnterEdge(currentEdgeOf(rickshaw))) {
             rickshaw->setIsStuck(true);
         }
     }
@@ -703,7 +842,7 @@ inline void TransportManager::simulateRickshawStep() {
                         rick->setRouteSimple(route, 0.1);
                         rick->setStatus(VehicleStatus::EN_ROUTE);
 
-                        if (!cityGraph->tryEnterEdge(currentNode, nextNode)) {
+                        if (!cityGraph->tryEnterEdge(currentEdgeOf(rick))) {
                             rick->setIsStuck(true);
                         }
                     }
@@ -712,12 +851,12 @@ inline void TransportManager::simulateRickshawStep() {
             continue;
         }
 
-        // Handle stuck state
+        // Handle stuck state (a detour may have opened up while waiting)
         if (rick->getIsStuck()) {
-            int currentNode = rick->getCurrentNodeID();
+            if (cityGraph) refreshVehicleRoute(rick);
             int nextNode = rick->getNextNodeID();
             if (cityGraph && nextNode != -1) {
-                if (cityGraph->tryEnterEdge(currentNode, nextNode)) {
+                if (cityGraph->tryEnterEdge(currentEdgeOf(rick))) {
                     rick->setIsStuck(false);
                 }
                 else {
@@ -739,9 +878,10 @@ inline void TransportManager::simulateRickshawStep() {
             // Normalize speed by edge distance to prevent teleporting
             double edgeDistance = 1.0;
             if (cityGraph && nextNode != -1) {
-                const Edge* edge = cityGraph->getEdge(currentNode, nextNode);
+                int edgeID = currentEdgeOf(rick);
+                const Edge* edge = cityGraph->getEdgeByID(edgeID);
                 if (edge && edge->weight > 0) edgeDistance = edge->weight;
-                double congestion = cityGraph->getEdgeCongestion(currentNode, nextNode);
+                double congestion = cityGraph->getEdgeCongestion(edgeID);
                 double speedMultiplier = 1.0 - 0.5 * congestion * congestion;
                 if (speedMultiplier < 0.2) speedMultiplier = 0.2;
                 progress += (baseSpeed / edgeDistance) * speedMultiplier;
@@ -764,9 +904,10 @@ inline void TransportManager::simulateRickshawStep() {
             }
 
             if (rick->getProgressOnEdge() >= 1.0) {
-                if (cityGraph && nextNode != -1) cityGraph->leaveEdge(currentNode, nextNode);
+                if (cityGraph && nextNode != -1) cityGraph->leaveEdge(currentEdgeOf(rick));
 
                 if (!rick->moveToNextStop()) {
+                    releaseVehicleRoute(rick);
                     // Reached destination
                     if (status == VehicleStatus::PICKING_UP) {
                         // At pickup location - would load passenger and start drop-off route
@@ -782,10 +923,10 @@ inline void TransportManager::simulateRickshawStep() {
                     }
                 }
                 else {
-                    int newCurrent = rick->getCurrentNodeID();
+                    if (cityGraph) refreshVehicleRoute(rick);
                     int newNext = rick->getNextNodeID();
                     if (cityGraph && newNext != -1) {
-                        if (!cityGraph->tryEnterEdge(newCurrent, newNext)) {
+                        if (!cityGraph->tryEnterEdge(currentEdgeOf(rick))) {
                             rick->setIsStuck(true);
                         }
                     }
@@ -810,7 +951,7 @@ inline string TransportManager::requestTransfer(const string& patientCNIC, const
         destHospitalID, destNodeID, destSector,
         priority, condition);
 
-    transferQueue.push(transfer);
+    transferQueue.push(transfer, EmergencyPriority::getValue(priority));
     ++totalTransferRequests;
 
     return requestID;
@@ -820,7 +961,8 @@ inline Ambulance* TransportManager::dispatchNextTransfer() {
     if (transferQueue.empty()) return nullptr;
 
     PatientTransfer transfer = transferQueue.top();
-    Ambulance* amb = findAmbulanceForTransfer(transfer.sourceSector, transfer.destSector);
+    Ambulance* amb = findAmbulanceForTransfer(transfer.sourceSector, transfer.destSector,
+        transfer.sourceHospitalNodeID);
 
     if (amb) {
         transferQueue.pop();
@@ -879,25 +1021,125 @@ inline void TransportManager::processBusArrival(Bus* bus, int stopNodeID) {
 
     BusStopQueue* queue = getStopQueue(stopNodeID);
     if (queue) {
-        while (!queue->waitingPassengers.empty() && !bus->isFull()) {
-            Passenger p = queue->waitingPassengers.dequeue();
-
-            int destPos = bus->getRoutePosition(p.destinationStopID);
-            int currentPos = bus->getCurrentRouteIndex();
-
-            if (destPos > currentPos) {
-                bus->addWaitingPassenger(p);
-                bus->boardWaitingPassengers();
-            }
-            else {
-                queue->waitingPassengers.enqueue(p);
+        // Everyone waiting is looked at once, a free seat's worth at a time; riders this
+        // bus cannot take go back in line
+        int waiting = queue->waitingPassengers.size();
+        int currentPos = bus->getCurrentRouteIndex();
+        while (waiting > 0 && !bus->isFull()) {
+            int batch = bus->getAvailableCapacity();
+            if (batch > waiting) batch = waiting;
+            waiting -= queue->waitingPassengers.drain(batch, arrivingPassengers);
+
+            for (int i = 0; i < arrivingPassengers.getSize(); i++) {
+                Passenger& p = arrivingPassengers[i];
+                if (bus->getRoutePosition(p.destinationStopID) > currentPos) {
+                    bus->addWaitingPassenger(std::move(p));
+                }
+                else {
+                    queue->waitingPassengers.enqueue(std::move(p));
+                }
             }
+            arrivingPassengers.clear();
+            bus->boardWaitingPassengers();
         }
     }
 }
 
 // ==================== SIMULATION ====================
 
+// The handle is cached on the vehicle and checked in O(1) against its current node pair,
+// so the road list is only searched once per road a vehicle drives onto.
+inline int TransportManager::currentEdgeOf(Vehicle* vehicle) {
+    int from = vehicle->getCurrentNodeID();
+    int to = vehicle->getNextNodeID();
+    int edgeID = vehicle->getCurrentEdgeID();
+    if (!cityGraph->isEdgeBetween(edgeID, from, to)) {
+        edgeID = cityGraph->getEdgeID(from, to);
+        vehicle->setCurrentEdgeID(edgeID);
+    }
+    return edgeID;
+}
+
+inline int TransportManager::nextSpreadKey(int fromNodeID, int toNodeID) {
+    long long key = ((long long)fromNodeID << 32) | (unsigned int)toNodeID;
+    int* trips = pairTrips.get(key);
+    if (!trips) {
+        pairTrips.insert(key, 1);
+        return 0;
+    }
+    return (*trips)++;
+}
+
+inline bool TransportManager::routeVehicleTo(Vehicle* vehicle, int goalNodeID, bool spread) {
+    if (!vehicle || !cityGraph) return false;
+    releaseVehicleRoute(vehicle);
+
+    // Keys that land on the shortest route skip the alternative search and get the
+    // incremental route below
+    int spreadKey = spread ? nextSpreadKey(vehicle->getCurrentNodeID(), goalNodeID) : 0;
+    if (spreadKey % ALTERNATIVE_ROUTE_COUNT != 0) {
+        double distance = 0.0;
+        int picked = -1;
+        Vector<int> path = cityGraph->findSpreadRoute(vehicle->getCurrentNodeID(), goalNodeID,
+            spreadKey, distance, true, &picked);
+        if (picked == -1) return false;
+        if (picked > 0) {
+            vehicle->setRouteSimple(path, distance);
+            return true;
+        }
+    }
+
+    int handle = cityGraph->openIncrementalRoute(vehicle->getCurrentNodeID(), goalNodeID);
+    if (handle == -1) return false;
+
+    double distance = 0.0;
+    Vector<int> path = cityGraph->getIncrementalRoute(handle, distance);
+    if (path.getSize() == 0) {
+        cityGraph->closeIncrementalRoute(handle);
+        return false;
+    }
+
+    vehicle->setRouteSimple(path, distance);
+    vehicle->setRouteHandle(handle);
+    return true;
+}
+
+// Cheap unless the router saw a weight change in the area this route searched
+inline void TransportManager::refreshVehicleRoute(Vehicle* vehicle) {
+    int handle = vehicle->getRouteHandle();
+    if (handle == -1) return;
+
+    // Somebody else replaced the route since it was opened
+    const LinkedList<RouteNode>& route = vehicle->getRoute();
+    if (route.size() == 0 || route.back().graphNodeID != cityGraph->getIncrementalRouteGoal(handle)) {
+        releaseVehicleRoute(vehicle);
+        return;
+    }
+
+    cityGraph->advanceIncrementalRoute(handle, vehicle->getCurrentNodeID());
+    if (!cityGraph->isIncrementalRouteAffected(handle)) return;
+
+    double distance = 0.0;
+    Vector<int> path = cityGraph->getIncrementalRoute(handle, distance);
+    if (path.getSize() < 2) return;     // Keep driving the old route if the goal was cut off
+
+    // Only reset the route if the road ahead actually differs (one walk down the list)
+    int index = vehicle->getCurrentRouteIndex();
+    bool same = (route.size() - index == path.getSize());
+    auto* curr = route.getHead();
+    for (int i = 0; same && i < index; i++) curr = curr->next;
+    for (int i = 0; same && i < path.getSize(); i++, curr = curr->next) {
+        same = (curr->data.graphNodeID == path[i]);
+    }
+    if (!same) vehicle->setRouteSimple(path, distance);
+}
+
+inline void TransportManager::releaseVehicleRoute(Vehicle* vehicle) {
+    if (vehicle->getRouteHandle() == -1) return;
+    if (cityGraph) cityGraph->closeIncrementalRoute(vehicle->getRouteHandle());
+    vehicle->setRouteHandle(-1);
+}
+
 inline void TransportManager::runSimulationStep() {
     ++simulationStep;
 
@@ -951,7 +1193,7 @@ inline void TransportManager::simulateBusStep() {
 
         if (bus->getIsStuck()) {
             if (cityGraph && nextNode != -1) {
-                if (cityGraph->tryEnterEdge(currentNode, nextNode)) {
+                if (cityGraph->tryEnterEdge(currentEdgeOf(bus))) {
                     bus->setIsStuck(false);
                 }
                 else {
@@ -966,9 +1208,10 @@ inline void TransportManager::simulateBusStep() {
         // Normalize speed by edge distance to prevent teleporting
         double edgeDistance = 1.0;
         if (cityGraph && nextNode != -1) {
-            const Edge* edge = cityGraph->getEdge(currentNode, nextNode);
+            int edgeID = currentEdgeOf(bus);
+            const Edge* edge = cityGraph->getEdgeByID(edgeID);
             if (edge && edge->weight > 0) edgeDistance = edge->weight;
-            double congestion = cityGraph->getEdgeCongestion(currentNode, nextNode);
+            double congestion = cityGraph->getEdgeCongestion(edgeID);
             double speedMultiplier = 1.0 - 0.7 * congestion * congestion;
             if (speedMultiplier < 0.1) speedMultiplier = 0.1;
             progress += (baseSpeed / edgeDistance) * speedMultiplier;
@@ -990,13 +1233,12 @@ inline void TransportManager::simulateBusStep() {
         }
 
         if (progress >= 1.0) {
-            if (cityGraph && nextNode != -1) cityGraph->leaveEdge(currentNode, nextNode);
+            if (cityGraph && nextNode != -1) cityGraph->leaveEdge(currentEdgeOf(bus));
             processBusArrival(bus, nextNode);
             if (bus->moveToNextStop()) {
-                int newCurrent = bus->getCurrentNodeID();
                 int newNext = bus->getNextNodeID();
                 if (cityGraph && newNext != -1) {
-                    if (!cityGraph->tryEnterEdge(newCurrent, newNext)) {
+                    if (!cityGraph->tryEnterEdge(currentEdgeOf(bus))) {
                         bus->setIsStuck(true);
                     }
                 }
@@ -1012,10 +1254,9 @@ inline void TransportManager::simulateSchoolBusStep() {
 
         // Handle stuck state
         if (sb->getIsStuck()) {
-            int currentNode = sb->getCurrentNodeID();
             int nextNode = sb->getNextNodeID();
             if (cityGraph && nextNode != -1) {
-                if (cityGraph->tryEnterEdge(currentNode, nextNode)) {
+                if (cityGraph->tryEnterEdge(currentEdgeOf(sb))) {
                     sb->setIsStuck(false);
                 }
                 else {
@@ -1035,7 +1276,7 @@ inline void TransportManager::simulateSchoolBusStep() {
             }
 
             if (hasWaiting && pickups.getSize() > 0) {
-                sb->setPickupRoute(pickups);
+                sb->setPickupRoute(orderPickupsByDistance(sb->getCurrentNodeID(), pickups));
                 sb->startHomePickupRoute();
             }
         }
@@ -1052,9 +1293,10 @@ inline void TransportManager::simulateSchoolBusStep() {
             // Normalize speed by edge distance to prevent teleporting
             double edgeDistance = 1.0;
             if (cityGraph && nextNode != -1) {
-                const Edge* edge = cityGraph->getEdge(currentNode, nextNode);
+                int edgeID = currentEdgeOf(sb);
+                const Edge* edge = cityGraph->getEdgeByID(edgeID);
                 if (edge && edge->weight > 0) edgeDistance = edge->weight;
-                double congestion = cityGraph->getEdgeCongestion(currentNode, nextNode);
+                double congestion = cityGraph->getEdgeCongestion(edgeID);
                 double speedMultiplier = 1.0 - 0.6 * congestion * congestion;
                 if (speedMultiplier < 0.15) speedMultiplier = 0.15;
                 progress += (baseSpeed / edgeDistance) * speedMultiplier;
@@ -1077,7 +1319,7 @@ inline void TransportManager::simulateSchoolBusStep() {
             }
 
             if (progress >= 1.0) {
-                if (cityGraph && nextNode != -1) cityGraph->leaveEdge(currentNode, nextNode);
+                if (cityGraph && nextNode != -1) cityGraph->leaveEdge(currentEdgeOf(sb));
 
                 if (!sb->moveToNextStop()) {
                     if (status == SchoolBusStatus::EN_ROUTE_HOME_PICKUP) {
@@ -1093,10 +1335,9 @@ inline void TransportManager::simulateSchoolBusStep() {
                     }
                 }
                 else {
-                    int newCurrent = sb->getCurrentNodeID();
                     int newNext = sb->getNextNodeID();
                     if (cityGraph && newNext != -1) {
-                        if (!cityGraph->tryEnterEdge(newCurrent, newNext)) {
+                        if (!cityGraph->tryEnterEdge(currentEdgeOf(sb))) {
                             sb->setIsStuck(true);
                         }
                     }
@@ -1108,12 +1349,7 @@ inline void TransportManager::simulateSchoolBusStep() {
             int pickupNode = sb->getCurrentNodeID();
             PickupPoint* pp = getPickupPoint(pickupNode);
 
-            if (pp) {
-                while (!pp->waitingStudents.empty() && !sb->isFull()) {
-                    StudentPassenger student = pp->waitingStudents.dequeue();
-                    sb->boardStudent(student);
-                }
-            }
+            if (pp) sb->boardStudentsFrom(pp->waitingStudents);
 
             if (sb->isFull() || sb->allPickupsComplete()) {
                 sb->startSchoolRoute();
@@ -1140,13 +1376,13 @@ inline void TransportManager::simulateAmbulanceStep() {
             continue;
         }
 
-        // Handle stuck state
+        // Handle stuck state (a detour may have opened up while waiting)
         if (amb->getIsStuck()) {
-            int currentNode = amb->getCurrentNodeID();
+            if (cityGraph) refreshVehicleRoute(amb);
             int nextNode = amb->getNextNodeID();
             if (cityGraph && nextNode != -1) {
                 // Ambulances have priority - always try to enter
-                if (cityGraph->tryEnterEdge(currentNode, nextNode)) {
+                if (cityGraph->tryEnterEdge(currentEdgeOf(amb))) {
                     amb->setIsStuck(false);
                 }
                 else {
@@ -1168,9 +1404,10 @@ inline void TransportManager::simulateAmbulanceStep() {
             // Normalize speed by edge distance to prevent teleporting
             double edgeDistance = 1.0;
             if (cityGraph && nextNode != -1) {
-                const Edge* edge = cityGraph->getEdge(currentNode, nextNode);
+                int edgeID = currentEdgeOf(amb);
+                const Edge* edge = cityGraph->getEdgeByID(edgeID);
                 if (edge && edge->weight > 0) edgeDistance = edge->weight;
-                double congestion = cityGraph->getEdgeCongestion(currentNode, nextNode);
+                double congestion = cityGraph->getEdgeCongestion(edgeID);
                 // Ambulances are less affected by congestion (emergency)
                 double speedMultiplier = 1.0 - 0.3 * congestion * congestion;
                 if (speedMultiplier < 0.3) speedMultiplier = 0.3;
@@ -1194,9 +1431,10 @@ inline void TransportManager::simulateAmbulanceStep() {
             }
 
             if (progress >= 1.0) {
-                if (cityGraph && nextNode != -1) cityGraph->leaveEdge(currentNode, nextNode);
+                if (cityGraph && nextNode != -1) cityGraph->leaveEdge(currentEdgeOf(amb));
 
                 if (!amb->moveToNextStop()) {
+                    releaseVehicleRoute(amb);
                     // Reached destination
                     if (status == AmbulanceStatus::DISPATCHED) {
                         amb->arriveAtPickup();
@@ -1210,10 +1448,10 @@ inline void TransportManager::simulateAmbulanceStep() {
                     }
                 }
                 else {
-                    int newCurrent = amb->getCurrentNodeID();
+                    if (cityGraph) refreshVehicleRoute(amb);
                     int newNext = amb->getNextNodeID();
                     if (cityGraph && newNext != -1) {
-                        if (!cityGraph->tryEnterEdge(newCurrent, newNext)) {
+                        if (!cityGraph->tryEnterEdge(currentEdgeOf(amb))) {
                             amb->setIsStuck(true);
                         }
                     }
@@ -1239,12 +1477,7 @@ inline void TransportManager::processSchoolBusPickup(SchoolBus* sb, int pickupNo
     sb->setSchoolBusStatus(SchoolBusStatus::AT_PICKUP_POINT);
 
     PickupPoint* pp = getPickupPoint(pickupNodeID);
-    if (pp) {
-        while (!pp->waitingStudents.empty() && !sb->isFull()) {
-            StudentPassenger student = pp->waitingStudents.dequeue();
-            sb->boardStudent(student);
-        }
-    }
+    if (pp) sb->boardStudentsFrom(pp->waitingStudents);
 }
 
 inline void TransportManager::processSchoolBusSchoolArrival(SchoolBus* sb, const string& schoolID, int schoolNodeID) {
@@ -1336,8 +1569,10 @@ inline bool TransportManager::loadBusesFromCSV(const string& filename, bool hasH
                 int endNode = cityGraph->getIDByDatabaseID(endID);
 
                 if (startNode != -1 && endNode != -1) {
+                    // A second bus between the same terminals takes a different road where there is one
                     double dist = 0;
-                    Vector<int> routeNodes = cityGraph->findShortestPath(startNode, endNode, dist);
+                    Vector<int> routeNodes = cityGraph->findSpreadRoute(startNode, endNode,
+                        nextSpreadKey(startNode, endNode), dist);
                     if (routeNodes.getSize() > 0) {
                         bus->setRouteSimple(routeNodes, dist);
                         // Force initial position so it's not invisible
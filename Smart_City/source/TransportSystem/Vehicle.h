@@ -75,6 +75,8 @@ protected:
 
     // ==================== SPATIAL AWARENESS (Phase 2) ====================
     int nextNodeID;             // The node the vehicle is trying to reach
+    int currentEdgeID;          // CityGraph edge handle last resolved for the current road (-1 = none)
+    int routeHandle;            // CityGraph incremental route to the end of the route (-1 = fixed route)
     double progressOnEdge;      // 0.0 to 1.0, position on current road segment
     bool isStuck;               // True if road is at capacity, vehicle must wait
     int waitingTicks;           // How long the vehicle has been stuck
@@ -93,7 +95,7 @@ public:
           homeSector(""), homeNodeID(-1),
           totalDistance(0.0), distanceTraveled(0.0), speed(40.0),
           maxCapacity(0), currentOccupancy(0),
-          nextNodeID(-1), progressOnEdge(0.0), isStuck(false), waitingTicks(0),
+          nextNodeID(-1), currentEdgeID(-1), routeHandle(-1), progressOnEdge(0.0), isStuck(false), waitingTicks(0),
           renderLat(0.0), renderLon(0.0) {}
     
     Vehicle(const string& id, const string& type, int capacity)
@@ -102,13 +104,15 @@ public:
           homeSector(""), homeNodeID(-1),
           totalDistance(0.0), distanceTraveled(0.0), speed(40.0),
           maxCapacity(capacity), currentOccupancy(0),
-          nextNodeID(-1), progressOnEdge(0.0), isStuck(false), waitingTicks(0),
+          nextNodeID(-1), currentEdgeID(-1), routeHandle(-1), progressOnEdge(0.0), isStuck(false), waitingTicks(0),
           renderLat(0.0), renderLon(0.0) {}
     
     virtual ~Vehicle() = default;
     
     // ==================== SPATIAL GETTERS ====================
     int getNextNodeID() const { return nextNodeID; }
+    int getCurrentEdgeID() const { return currentEdgeID; }
+    int getRouteHandle() const { return routeHandle; }
     double getProgressOnEdge() const { return progressOnEdge; }
     bool getIsStuck() const { return isStuck; }
     int getWaitingTicks() const { return waitingTicks; }
@@ -118,6 +122,8 @@ public:
     
     // ==================== SPATIAL SETTERS ====================
     void setNextNodeID(int nodeID) { nextNodeID = nodeID; }
+    void setCurrentEdgeID(int edgeID) { currentEdgeID = edgeID; }
+    void setRouteHandle(int handle) { routeHandle = handle; }
     void setProgressOnEdge(double progress) { progressOnEdge = progress; }
     void setIsStuck(bool stuck) { 
         isStuck = stuck; 